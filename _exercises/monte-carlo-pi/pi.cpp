@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <execution>
 
+#include "thread_pool.hpp"
+
 /*******************************************************
  * https://academo.org/demos/estimating-pi-monte-carlo
  * *****************************************************/
@@ -375,6 +377,46 @@ void pi_parallel_stl()
     cout << "Elapsed = " << elapsed_time << "ms" << endl;    
 }
 
+void pi_thread_pool()
+{
+    ThreadPool pool;
+
+    cout << "number_of_workers: " << pool.size() << endl;
+
+    cout << "Pi calculation started! ThreadPool::parallel_reduce!" << endl;
+    const auto start = chrono::high_resolution_clock::now();
+
+    // no manual chunking - the range is split lazily while workers are hungry, the main thread helps
+    auto hits = pool.parallel_reduce(
+        uintmax_t{0}, N, uintmax_t{0},
+        [](uintmax_t first, uintmax_t last, uintmax_t hits) {
+            // engine is built once per worker and its sequence continues across the chunks the worker runs
+            auto& rnd_gen = worker_local<std::mt19937_64>([] {
+                return std::mt19937_64(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            });
+            std::uniform_real_distribution<double> rnd(0, 1.0);
+
+            for (uintmax_t n = first; n < last; ++n)
+            {
+                double x = rnd(rnd_gen);
+                double y = rnd(rnd_gen);
+                if (x * x + y * y < 1)
+                    hits++;
+            }
+
+            return hits;
+        },
+        std::plus{});
+
+    const double pi = static_cast<double>(hits) / N * 4;
+
+    const auto end = chrono::high_resolution_clock::now();
+    const auto elapsed_time = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+
+    cout << "Pi = " << pi << endl;
+    cout << "Elapsed = " << elapsed_time << "ms" << endl;
+}
+
 int main()
 {
     single_thread_pi();
@@ -406,4 +448,8 @@ int main()
     std::cout << "///////////////////////////////////////////////////" << std::endl;
 
     pi_parallel_stl();
+
+    std::cout << "///////////////////////////////////////////////////" << std::endl;
+
+    pi_thread_pool();
 }
\ No newline at end of file
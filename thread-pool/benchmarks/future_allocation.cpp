@@ -0,0 +1,111 @@
+#include "allocation_counter.hpp"
+#include "future.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cost of the future returned for every task:
+//  - std::packaged_task - its shared state comes from the heap on every task
+//  - Promise/Future - the shared state comes from the per-thread freelists of PooledAllocator
+
+const int iterations = 1'000'000;
+
+template <typename MakeTask>
+void measure_single_thread(const std::string& name, MakeTask make_task)
+{
+    long sum = 0;
+
+    const long allocations_before = allocation_count.load();
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto [task, f] = make_task(i);
+        task();
+        sum += f.get();
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long allocations = allocation_count.load() - allocations_before;
+
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations << "ns/task; "
+              << static_cast<double>(allocations) / iterations << " allocations/task"
+              << " (checksum " << sum << ")" << std::endl;
+}
+
+// Tasks submitted in batches from the main thread, futures collected there
+template <typename Submit>
+void measure_pool(const std::string& name, Submit submit)
+{
+    const int batch_size = 1'000;
+    ThreadPool pool{std::max(std::thread::hardware_concurrency(), 1u)};
+    long sum = 0;
+
+    const long allocations_before = allocation_count.load();
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (int batch = 0; batch < iterations / batch_size; ++batch)
+        sum += submit(pool, batch_size);
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long allocations = allocation_count.load() - allocations_before;
+
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations << "ns/task; "
+              << static_cast<double>(allocations) / iterations << " allocations/task"
+              << " (checksum " << sum << ")" << std::endl;
+}
+
+int main()
+{
+    std::cout << "* create, run and get (one thread)\n";
+
+    measure_single_thread("std::packaged_task + std::future", [](int x) {
+        std::packaged_task<int()> pt{[x] { return x % 7; }};
+        auto f = pt.get_future();
+        return std::pair{std::move(pt), std::move(f)};
+    });
+
+    measure_single_thread("Promise + Future (pooled state)", [](int x) {
+        Promise<int> promise;
+        auto f = promise.get_future();
+        Task task{[promise = std::move(promise), x]() mutable { promise.set_value(x % 7); }};
+        return std::pair{std::move(task), std::move(f)};
+    });
+
+    std::cout << "* thread pool round trip\n";
+
+    measure_pool("execute(packaged_task) + std::future", [](ThreadPool& pool, int count) {
+        std::vector<std::future<int>> futures;
+        futures.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            std::packaged_task<int()> pt{[i] { return i % 7; }};
+            futures.push_back(pt.get_future());
+            pool.execute(Task{std::move(pt)});
+        }
+
+        long sum = 0;
+        for (auto& f : futures)
+            sum += f.get();
+        return sum;
+    });
+
+    measure_pool("submit + Future (pooled state)", [](ThreadPool& pool, int count) {
+        std::vector<Future<int>> futures;
+        futures.reserve(count);
+        for (int i = 0; i < count; ++i)
+            futures.push_back(pool.submit([i] { return i % 7; }));
+
+        long sum = 0;
+        for (auto& f : futures)
+            sum += f.get();
+        return sum;
+    });
+}
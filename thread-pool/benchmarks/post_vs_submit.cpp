@@ -0,0 +1,39 @@
+#include "allocation_counter.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Fire-and-forget tasks from a non-worker thread: submit() with the future thrown away vs post()
+
+const int iterations = 1'000'000;
+
+template <typename Enqueue>
+void measure(const std::string& name, Enqueue enqueue)
+{
+    std::atomic<long> counter{0};
+
+    const long allocations_before = allocation_count.load();
+    const auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool{std::max(std::thread::hardware_concurrency(), 1u)};
+        for (int i = 0; i < iterations; ++i)
+            enqueue(pool, [&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+    } // drains the pool
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long allocations = allocation_count.load() - allocations_before;
+
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations << "ns/task; "
+              << static_cast<double>(allocations) / iterations << " allocations/task"
+              << " (executed " << counter << ")" << std::endl;
+}
+
+int main()
+{
+    measure("submit (future discarded)", [](ThreadPool& pool, auto task) { pool.submit(task); });
+    measure("post", [](ThreadPool& pool, auto task) { pool.post(task); });
+}
@@ -0,0 +1,75 @@
+#include "mpmc_ring_queue.hpp"
+#include "thread_safe_queue.hpp"
+#include "two_lock_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Blocking push/pop of ints through a shared queue: producers x consumers threads, items spread evenly
+
+const int item_count = 1'000'000;
+const size_t ring_capacity = 1024;
+
+template <typename Queue>
+double items_per_second(Queue& q, unsigned int producers, unsigned int consumers)
+{
+    std::atomic<long> popped{0};
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    {
+        std::vector<std::jthread> consumer_threads;
+        for (unsigned int c = 0; c < consumers; ++c)
+        {
+            consumer_threads.emplace_back([&] {
+                long count = 0;
+                while (q.pop())
+                    ++count;
+                popped += count;
+            });
+        }
+
+        std::vector<std::jthread> producer_threads;
+        for (unsigned int p = 0; p < producers; ++p)
+        {
+            producer_threads.emplace_back([&, p] {
+                for (int i = p; i < item_count; i += producers)
+                    q.push(i);
+            });
+        }
+
+        producer_threads.clear(); // joins
+        q.close();
+    } // joins consumers
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    if (popped != item_count)
+        std::cerr << "lost items: " << item_count - popped << std::endl;
+
+    const std::chrono::duration<double> elapsed = end - start;
+    return item_count / elapsed.count();
+}
+
+int main()
+{
+    const unsigned int max_threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+    std::cout << "producers; consumers; ThreadSafeQueue [items/s]; TwoLockQueue [items/s]; MpmcRingQueue [items/s]\n";
+
+    for (unsigned int producers = 1; producers <= max_threads; producers *= 2)
+    {
+        for (unsigned int consumers = 1; consumers <= max_threads; consumers *= 2)
+        {
+            ThreadSafeQueue<int> locked;
+            TwoLockQueue<int> two_lock;
+            MpmcRingQueue<int> ring{ring_capacity};
+
+            std::cout << producers << "; " << consumers << "; "
+                      << static_cast<long>(items_per_second(locked, producers, consumers)) << "; "
+                      << static_cast<long>(items_per_second(two_lock, producers, consumers)) << "; "
+                      << static_cast<long>(items_per_second(ring, producers, consumers)) << std::endl;
+        }
+    }
+}
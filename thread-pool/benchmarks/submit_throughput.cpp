@@ -0,0 +1,91 @@
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <latch>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Throughput of fan-out workloads: every worker keeps submitting tiny tasks from inside the pool
+
+using namespace std::literals;
+
+const int tasks_per_producer = 100'000;
+
+double tasks_per_second(unsigned int workers, ThreadPool::Scheduling scheduling)
+{
+    std::atomic<long> counter{0};
+    std::latch done{static_cast<std::ptrdiff_t>(workers)};
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool{workers, scheduling};
+
+        for (unsigned int p = 0; p < workers; ++p)
+        {
+            pool.submit([&] {
+                for (int i = 0; i < tasks_per_producer; ++i)
+                    pool.submit([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+                done.count_down();
+            });
+        }
+
+        done.wait();
+    } // drains the pool
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const std::chrono::duration<double> elapsed = end - start;
+    return counter / elapsed.count();
+}
+
+// Fan-out of tiny tasks from a non-worker thread: submit() in a loop vs one submit_bulk()
+template <typename Submit>
+double external_tasks_per_second(unsigned int workers, Submit submit)
+{
+    std::atomic<long> counter{0};
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    {
+        ThreadPool pool{workers};
+        submit(pool, [&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const std::chrono::duration<double> elapsed = end - start;
+    return counter / elapsed.count();
+}
+
+int main()
+{
+    const unsigned int max_workers = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::cout << "workers; shared_queue [tasks/s]; work_stealing [tasks/s]\n";
+
+    for (unsigned int workers = 1; workers <= max_workers; workers *= 2)
+    {
+        std::cout << workers << "; "
+                  << static_cast<long>(tasks_per_second(workers, ThreadPool::Scheduling::shared_queue)) << "; "
+                  << static_cast<long>(tasks_per_second(workers, ThreadPool::Scheduling::work_stealing)) << std::endl;
+    }
+
+    std::cout << "\nworkers; submit loop [tasks/s]; submit_bulk [tasks/s]\n";
+
+    for (unsigned int workers = 1; workers <= max_workers; workers *= 2)
+    {
+        const auto loop = [](ThreadPool& pool, auto task) {
+            for (int i = 0; i < tasks_per_producer; ++i)
+                pool.submit(task);
+        };
+
+        const auto bulk = [](ThreadPool& pool, auto task) {
+            pool.submit_bulk(std::views::iota(0, tasks_per_producer) | std::views::transform([task](int) { return task; }));
+        };
+
+        std::cout << workers << "; "
+                  << static_cast<long>(external_tasks_per_second(workers, loop)) << "; "
+                  << static_cast<long>(external_tasks_per_second(workers, bulk)) << std::endl;
+    }
+}
@@ -0,0 +1,87 @@
+#include "allocation_counter.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Cost of wrapping a typical lambda into a queued task:
+//  - previous ThreadPool path: shared_ptr<packaged_task> captured by std::function<void()>
+//  - current path: packaged_task moved into Task (inline storage)
+
+const int iterations = 1'000'000;
+
+volatile size_t sink; // keeps the work of the benchmarked lambdas observable
+
+template <typename Wrap>
+void measure(const std::string& name, Wrap wrap)
+{
+    std::deque<decltype(wrap(0))> queue;
+
+    const long allocations_before = allocation_count.load();
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        queue.push_back(wrap(i));
+        queue.front()();
+        queue.pop_front();
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long allocations = allocation_count.load() - allocations_before;
+
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations << "ns/task; "
+              << static_cast<double>(allocations) / iterations << " allocations/task" << std::endl;
+}
+
+int main()
+{
+    std::cout << "* lambda with future (submit)\n";
+
+    measure("std::function + shared_ptr<packaged_task>", [](int x) {
+        auto pt = std::make_shared<std::packaged_task<int()>>([x] { return x * x; });
+        auto f = pt->get_future();
+        return std::function<void()>{[pt] { (*pt)(); }};
+    });
+
+    measure("Task + packaged_task", [](int x) {
+        std::packaged_task<int()> pt{[x] { return x * x; }};
+        auto f = pt.get_future();
+        return Task{std::move(pt)};
+    });
+
+    std::cout << "* lambda capturing a string and an int (no future)\n";
+
+    measure("std::function", [](int x) {
+        return std::function<void()>{[text = "Text#" + std::to_string(x), x] { sink = text.size() + x; }};
+    });
+
+    measure("Task", [](int x) {
+        return Task{[text = "Text#" + std::to_string(x), x] { sink = text.size() + x; }};
+    });
+
+    std::cout << "* ThreadPool::submit\n";
+    {
+        ThreadPool pool{1};
+
+        const long allocations_before = allocation_count.load();
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+            pool.submit([i] { return i * i; }).get();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long allocations = allocation_count.load() - allocations_before;
+
+        std::cout << "submit + get: "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations << "ns/task; "
+                  << static_cast<double>(allocations) / iterations << " allocations/task" << std::endl;
+    }
+}
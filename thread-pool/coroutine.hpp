@@ -0,0 +1,556 @@
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include "future.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// C++20 coroutine support:
+//  - coro::Task<T> - lazily started coroutine; co_await on it starts it and suspends until it is done
+//  - co_await pool.schedule() - moves the coroutine to a worker of a ThreadPool
+//  - co_await future - suspends until a pool Future is ready (no thread is parked)
+//  - coro::when_all(tasks) - runs tasks concurrently, coro::spawn()/coro::sync_wait() - entry points from plain code
+
+namespace detail
+{
+    // Task that resumes a suspended coroutine. Destroyed unrun (dropped by an aborted or shut down executor)
+    // it resumes the coroutine inline and marks the optional State as dropped - a coroutine is never leaked suspended.
+    class Resumption
+    {
+    public:
+        // Lives in the awaiter; the awaiter disarms it when the resumption was never queued
+        struct State
+        {
+            bool armed = true;
+            bool dropped = false;
+        };
+
+        explicit Resumption(std::coroutine_handle<> handle, State* state = nullptr) noexcept
+            : m_handle{handle}
+            , m_state{state}
+        {
+        }
+
+        Resumption(Resumption&& other) noexcept
+            : m_handle{std::exchange(other.m_handle, nullptr)}
+            , m_state{other.m_state}
+        {
+        }
+
+        Resumption& operator=(Resumption&&) = delete;
+
+        ~Resumption()
+        {
+            if (!m_handle || (m_state && !m_state->armed))
+                return;
+
+            if (m_state)
+                m_state->dropped = true;
+            m_handle.resume();
+        }
+
+        void operator()()
+        {
+            std::exchange(m_handle, nullptr).resume();
+        }
+
+    private:
+        std::coroutine_handle<> m_handle;
+        State* m_state;
+    };
+
+    // FutureRef is Future<T>& for an lvalue operand, Future<T> (owned) for an rvalue
+    template <typename T, typename FutureRef>
+    class FutureAwaiter
+    {
+    public:
+        explicit FutureAwaiter(FutureRef future)
+            : m_future{std::forward<FutureRef>(future)}
+        {
+        }
+
+        bool await_ready() const
+        {
+            return m_future.is_ready();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // the coroutine continues on the pool, not inside set_value() - or inline once the pool is destroyed
+            m_future.on_ready([handle, link = m_future.executor_link()] {
+                if (link)
+                    link->execute(Task{Resumption{handle}});
+                else
+                    handle.resume();
+            });
+        }
+
+        T await_resume()
+        {
+            return m_future.get();
+        }
+
+    private:
+        FutureRef m_future;
+    };
+} // namespace detail
+
+template <typename T>
+auto operator co_await(Future<T>& future)
+{
+    return detail::FutureAwaiter<T, Future<T>&>{future};
+}
+
+template <typename T>
+auto operator co_await(Future<T>&& future)
+{
+    return detail::FutureAwaiter<T, Future<T>>{std::move(future)};
+}
+
+namespace coro
+{
+    template <typename T = void>
+    class Task;
+
+    namespace detail
+    {
+        class PromiseBase
+        {
+        public:
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            // symmetric transfer to the awaiting coroutine - no stack growth along long chains
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+                {
+                    auto continuation = handle.promise().m_continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            FinalAwaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void set_continuation(std::coroutine_handle<> continuation) noexcept
+            {
+                m_continuation = continuation;
+            }
+
+        private:
+            std::coroutine_handle<> m_continuation;
+        };
+
+        template <typename T>
+        class TaskPromise : public PromiseBase
+        {
+        public:
+            Task<T> get_return_object() noexcept;
+
+            template <typename Value>
+                requires std::convertible_to<Value, T>
+            void return_value(Value&& value)
+            {
+                m_result.template emplace<1>(std::forward<Value>(value));
+            }
+
+            void unhandled_exception() noexcept
+            {
+                m_result.template emplace<2>(std::current_exception());
+            }
+
+            T result()
+            {
+                if (m_result.index() == 2)
+                    std::rethrow_exception(std::get<2>(m_result));
+                return std::move(std::get<1>(m_result));
+            }
+
+        private:
+            std::variant<std::monostate, T, std::exception_ptr> m_result;
+        };
+
+        template <>
+        class TaskPromise<void> : public PromiseBase
+        {
+        public:
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept
+            {
+            }
+
+            void unhandled_exception() noexcept
+            {
+                m_eptr = std::current_exception();
+            }
+
+            void result()
+            {
+                if (m_eptr)
+                    std::rethrow_exception(m_eptr);
+            }
+
+        private:
+            std::exception_ptr m_eptr;
+        };
+    } // namespace detail
+
+    // Lazily started coroutine: the body runs when the task is awaited, the awaiter is resumed when it completes.
+    // The result (or the exception) of the body is returned by co_await.
+    template <typename T>
+    class [[nodiscard]] Task
+    {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+        using value_type = T;
+
+        Task() = default;
+
+        Task(Task&& other) noexcept
+            : m_handle{std::exchange(other.m_handle, nullptr)}
+        {
+        }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Task()
+        {
+            destroy();
+        }
+
+        bool is_ready() const noexcept
+        {
+            return !m_handle || m_handle.done();
+        }
+
+        auto operator co_await() && noexcept
+        {
+            return Awaiter{m_handle};
+        }
+
+        auto operator co_await() & noexcept
+        {
+            return Awaiter{m_handle};
+        }
+
+        // Awaitable that runs the task to completion without fetching (or rethrowing) its result
+        auto when_ready() noexcept
+        {
+            struct ReadyAwaiter : Awaiter
+            {
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            return ReadyAwaiter{{m_handle}};
+        }
+
+        // Result of a completed task
+        T result()
+        {
+            return m_handle.promise().result();
+        }
+
+    private:
+        friend class detail::TaskPromise<T>;
+
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept
+            {
+                return !handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().set_continuation(awaiting);
+                return handle; // starts the task
+            }
+
+            T await_resume()
+            {
+                if (!handle)
+                    throw std::future_error{std::future_errc::no_state};
+                return handle.promise().result();
+            }
+        };
+
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+            : m_handle{handle}
+        {
+        }
+
+        void destroy() noexcept
+        {
+            if (m_handle)
+                std::exchange(m_handle, nullptr).destroy();
+        }
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() noexcept
+        {
+            return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept
+        {
+            return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+
+        // Coroutine started at once and destroyed when it finishes - drives a Task from plain code
+        struct Detached
+        {
+            struct promise_type
+            {
+                Detached get_return_object() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never initial_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never final_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                void return_void() const noexcept
+                {
+                }
+
+                void unhandled_exception() const noexcept
+                {
+                    std::terminate();
+                }
+            };
+        };
+
+        template <typename T>
+        Detached drive(Task<T> task, Promise<T> promise)
+        {
+            co_await task.when_ready();
+
+            auto get_result = [&task] { return task.result(); };
+            promise.set_from(get_result);
+        }
+
+        // Shared by the children of when_all(); the last child to finish resumes the awaiting coroutine
+        struct WhenAllCounter
+        {
+            std::atomic<size_t> remaining;
+            std::coroutine_handle<> awaiting;
+
+            bool arrive() noexcept
+            {
+                return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+        };
+
+        class WhenAllChild
+        {
+        public:
+            struct promise_type
+            {
+                WhenAllCounter* counter = nullptr;
+
+                WhenAllChild get_return_object() noexcept
+                {
+                    return WhenAllChild{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                auto final_suspend() const noexcept
+                {
+                    struct FinalAwaiter
+                    {
+                        bool await_ready() const noexcept
+                        {
+                            return false;
+                        }
+
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                        {
+                            WhenAllCounter& counter = *handle.promise().counter;
+                            return counter.arrive() ? counter.awaiting : std::noop_coroutine();
+                        }
+
+                        void await_resume() const noexcept
+                        {
+                        }
+                    };
+
+                    return FinalAwaiter{};
+                }
+
+                void return_void() const noexcept
+                {
+                }
+
+                void unhandled_exception() const noexcept
+                {
+                    std::terminate(); // when_ready() does not throw
+                }
+            };
+
+            WhenAllChild(WhenAllChild&& other) noexcept
+                : m_handle{std::exchange(other.m_handle, nullptr)}
+            {
+            }
+
+            ~WhenAllChild()
+            {
+                if (m_handle)
+                    m_handle.destroy();
+            }
+
+            void start(WhenAllCounter& counter)
+            {
+                m_handle.promise().counter = &counter;
+                m_handle.resume();
+            }
+
+        private:
+            explicit WhenAllChild(std::coroutine_handle<promise_type> handle) noexcept
+                : m_handle{handle}
+            {
+            }
+
+            std::coroutine_handle<promise_type> m_handle;
+        };
+
+        template <typename T>
+        WhenAllChild run_child(Task<T>& task)
+        {
+            co_await task.when_ready();
+        }
+
+        // Starts all tasks on the awaiting thread (each runs until its first suspension, e.g. co_await pool.schedule())
+        // and resumes the awaiting coroutine when the last of them completes
+        template <typename T>
+        class WhenAllAwaiter
+        {
+        public:
+            explicit WhenAllAwaiter(std::vector<Task<T>>& tasks)
+                : m_tasks{tasks}
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return m_tasks.empty();
+            }
+
+            bool await_suspend(std::coroutine_handle<> awaiting)
+            {
+                m_counter.remaining.store(m_tasks.size() + 1, std::memory_order_relaxed);
+                m_counter.awaiting = awaiting;
+
+                m_children.reserve(m_tasks.size());
+                for (auto& task : m_tasks)
+                    m_children.push_back(run_child(task));
+                for (auto& child : m_children)
+                    child.start(m_counter);
+
+                return !m_counter.arrive(); // all children done already - continue without suspending
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+
+        private:
+            std::vector<Task<T>>& m_tasks;
+            WhenAllCounter m_counter{};
+            std::vector<WhenAllChild> m_children;
+        };
+    } // namespace detail
+
+    // Runs the tasks concurrently and returns their results in the order of the tasks;
+    // the first exception (in that order) is rethrown after all tasks have completed
+    template <typename T>
+    Task<std::vector<T>> when_all(std::vector<Task<T>> tasks)
+    {
+        co_await detail::WhenAllAwaiter<T>{tasks};
+
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for (auto& task : tasks)
+            results.push_back(task.result());
+
+        co_return results;
+    }
+
+    inline Task<void> when_all(std::vector<Task<void>> tasks)
+    {
+        co_await detail::WhenAllAwaiter<void>{tasks};
+
+        for (auto& task : tasks)
+            task.result();
+    }
+
+    // Starts the task on the calling thread; the future gets its result. Continuations of the future run on executor.
+    template <typename T>
+    Future<T> spawn(Task<T> task, Executor* executor = nullptr)
+    {
+        Promise<T> promise{executor};
+        Future<T> result = promise.get_future();
+        detail::drive(std::move(task), std::move(promise));
+        return result;
+    }
+
+    // Runs the task and blocks the calling thread until it completes
+    template <typename T>
+    T sync_wait(Task<T> task)
+    {
+        return spawn(std::move(task)).get();
+    }
+} // namespace coro
+
+#endif // COROUTINE_HPP
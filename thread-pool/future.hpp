@@ -0,0 +1,639 @@
+#ifndef FUTURE_HPP
+#define FUTURE_HPP
+
+#include "pooled_allocator.hpp"
+#include "task.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail
+{
+    class ExecutorLink;
+}
+
+// Something that runs tasks - continuations are scheduled on it and a blocked Future::get() uses it to help
+class Executor
+{
+public:
+    Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    virtual ~Executor();
+
+    // Queues the task; an executor that can no longer run it destroys it (dropped continuations break their promises)
+    virtual void execute(Task task) = 0;
+
+    virtual bool is_worker_thread() const = 0;
+
+    // Runs one pending task on the calling thread; false when there was nothing to run
+    virtual bool try_run_pending_task() = 0;
+
+    // Shared with the states of the futures bound to this executor - they reach it only through the link
+    const std::shared_ptr<detail::ExecutorLink>& link() const
+    {
+        return m_link;
+    }
+
+protected:
+    // Cuts the futures off the executor: afterwards they neither help it nor queue continuations on it
+    // (continuations run inline). Waits for the calls in progress. A derived executor calls it in its
+    // destructor once none of its own threads uses it any more - ~Executor() is too late for the virtual calls.
+    void detach_futures();
+
+private:
+    std::shared_ptr<detail::ExecutorLink> m_link;
+};
+
+namespace detail
+{
+    // Lifetime token of an executor held by future states, so a future may outlive its pool
+    class ExecutorLink
+    {
+    public:
+        explicit ExecutorLink(Executor* executor)
+            : m_executor{executor}
+        {
+        }
+
+        ExecutorLink(const ExecutorLink&) = delete;
+        ExecutorLink& operator=(const ExecutorLink&) = delete;
+
+        // Calls f(executor) while the executor cannot be detached; false (f not called) when it is gone
+        template <typename F>
+        bool with_executor(F&& f)
+        {
+            struct Use
+            {
+                std::atomic<int>& users;
+
+                ~Use()
+                {
+                    if (users.fetch_sub(1) == 1)
+                        users.notify_all();
+                }
+            };
+
+            m_users.fetch_add(1); // seq_cst - pairs with the store in detach()
+            Use use{m_users};
+            Executor* executor = m_executor.load();
+            if (!executor)
+                return false;
+
+            f(*executor);
+            return true;
+        }
+
+        // Queues the task on the executor or runs it inline when the executor is gone
+        void execute(Task task)
+        {
+            if (!with_executor([&task](Executor& executor) { executor.execute(std::move(task)); }))
+                task();
+        }
+
+        // A snapshot - the executor may be detached right after it is returned
+        Executor* executor() const
+        {
+            return m_executor.load();
+        }
+
+        void detach()
+        {
+            m_executor.store(nullptr);
+            for (int users = m_users.load(); users != 0; users = m_users.load())
+                m_users.wait(users);
+        }
+
+    private:
+        std::atomic<Executor*> m_executor;
+        std::atomic<int> m_users{0}; // calls of with_executor() in progress
+    };
+} // namespace detail
+
+inline Executor::Executor()
+    : m_link{std::make_shared<detail::ExecutorLink>(this)}
+{
+}
+
+inline Executor::~Executor()
+{
+    detach_futures();
+}
+
+inline void Executor::detach_futures()
+{
+    m_link->detach();
+}
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+namespace detail
+{
+    // How often a helping thread looks for new work when it has nothing to run
+    inline constexpr std::chrono::microseconds help_poll_interval{500};
+
+    template <typename T>
+    class FutureValue
+    {
+        std::optional<T> m_value;
+
+    public:
+        template <typename... Args>
+        void emplace(Args&&... args)
+        {
+            m_value.emplace(std::forward<Args>(args)...);
+        }
+
+        T take()
+        {
+            return std::move(*m_value);
+        }
+    };
+
+    template <>
+    class FutureValue<void>
+    {
+    public:
+        void emplace()
+        {
+        }
+
+        void take()
+        {
+        }
+    };
+
+    template <typename T>
+    class SharedState
+    {
+    public:
+        explicit SharedState(std::shared_ptr<ExecutorLink> link)
+            : m_link{std::move(link)}
+        {
+        }
+
+        SharedState(const SharedState&) = delete;
+        SharedState& operator=(const SharedState&) = delete;
+
+        template <typename... Args>
+        void set_value(Args&&... args)
+        {
+            complete([&] { m_value.emplace(std::forward<Args>(args)...); });
+        }
+
+        void set_exception(std::exception_ptr eptr)
+        {
+            complete([&] { m_eptr = std::move(eptr); });
+        }
+
+        // Fails the state unless it is ready already; called from destructors, so it never throws
+        void break_promise() noexcept
+        {
+            try
+            {
+                if (!is_ready())
+                    set_exception(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+            }
+            catch (...)
+            {
+            }
+        }
+
+        // The continuation is dispatched when the state becomes ready (at once if it already is)
+        void set_continuation(Task continuation)
+        {
+            {
+                std::lock_guard lk{m_mtx};
+                if (!is_ready())
+                {
+                    m_continuation = std::move(continuation);
+                    return;
+                }
+            }
+
+            dispatch(std::move(continuation));
+        }
+
+        // Unlike a continuation, an observer is called inline on the thread that makes the state ready (at once if it
+        // already is); any number of observers may be attached and the value stays in the state
+        void add_observer(Task observer)
+        {
+            {
+                std::lock_guard lk{m_mtx};
+                if (!is_ready())
+                {
+                    m_observers.push_back(std::move(observer));
+                    return;
+                }
+            }
+
+            observer();
+        }
+
+        const std::shared_ptr<ExecutorLink>& link() const
+        {
+            return m_link;
+        }
+
+        bool is_ready() const
+        {
+            return m_ready.load(std::memory_order_acquire);
+        }
+
+        // Helping wait: while the result is not ready a worker of the executor runs its pending tasks,
+        // so a worker waiting for a task of its own pool never blocks the pool (nor deadlocks a small one)
+        void wait()
+        {
+            bool is_helping = false;
+            if (m_link)
+                m_link->with_executor([&is_helping](Executor& executor) { is_helping = executor.is_worker_thread(); });
+
+            while (!is_ready())
+            {
+                bool has_helped = false;
+                if (is_helping)
+                    m_link->with_executor([&has_helped](Executor& executor) { has_helped = executor.try_run_pending_task(); });
+                if (has_helped)
+                    continue;
+
+                std::unique_lock lk{m_mtx};
+                if (is_helping)
+                    m_cv_ready.wait_for(lk, help_poll_interval, [this] { return is_ready(); });
+                else
+                    m_cv_ready.wait(lk, [this] { return is_ready(); });
+            }
+        }
+
+        template <typename Clock, typename Duration>
+        std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            std::unique_lock lk{m_mtx};
+            return m_cv_ready.wait_until(lk, deadline, [this] { return is_ready(); }) ? std::future_status::ready : std::future_status::timeout;
+        }
+
+        T get()
+        {
+            wait();
+
+            if (m_eptr)
+                std::rethrow_exception(m_eptr);
+
+            return m_value.take();
+        }
+
+    private:
+        void throw_if_satisfied() const
+        {
+            if (is_ready())
+                throw std::future_error{std::future_errc::promise_already_satisfied};
+        }
+
+        // Makes the state ready, then notifies: only fill() and the check before it may throw, so once the
+        // state is ready the caller sees no exception and set_from() never stores a second result
+        template <typename Fill>
+        void complete(Fill fill)
+        {
+            Task continuation;
+            std::vector<Task> observers;
+            {
+                std::lock_guard lk{m_mtx};
+                throw_if_satisfied();
+                fill();
+                m_ready.store(true, std::memory_order_release);
+                continuation = std::move(m_continuation);
+                observers.swap(m_observers);
+            }
+            m_cv_ready.notify_all();
+
+            notify(observers, continuation);
+        }
+
+        // The state is ready at this point, so nothing thrown here may reach the caller of set_value()/set_exception()
+        void notify(std::vector<Task>& observers, Task& continuation) noexcept
+        {
+            for (auto& observer : observers)
+            {
+                try
+                {
+                    observer();
+                }
+                catch (...)
+                {
+                    // an observer that throws loses only its own notification
+                }
+            }
+
+            if (continuation)
+                dispatch(std::move(continuation));
+        }
+
+        // Continuations run on the executor; without one (or when it no longer exists) they run inline on
+        // the thread that made the state ready. A continuation that cannot be queued is destroyed - it breaks
+        // its own promise.
+        void dispatch(Task continuation) noexcept
+        {
+            try
+            {
+                if (m_link)
+                    m_link->execute(std::move(continuation));
+                else
+                    continuation();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        const std::shared_ptr<ExecutorLink> m_link;
+        std::mutex m_mtx;
+        std::condition_variable m_cv_ready;
+        std::atomic<bool> m_ready{false};
+        FutureValue<T> m_value;
+        std::exception_ptr m_eptr;
+        Task m_continuation;
+        std::vector<Task> m_observers;
+    };
+} // namespace detail
+
+// Counterpart of std::future for results produced by ThreadPool tasks.
+// get()/wait() called from a worker of the pool help it until the result is ready.
+template <typename T>
+class Future
+{
+    static_assert(!std::is_reference_v<T>, "Future<T&> is not supported - return results by value");
+
+public:
+    Future() = default;
+
+    bool valid() const noexcept
+    {
+        return m_state != nullptr;
+    }
+
+    bool is_ready() const
+    {
+        throw_if_invalid();
+        return m_state->is_ready();
+    }
+
+    void wait() const
+    {
+        throw_if_invalid();
+        m_state->wait();
+    }
+
+    template <typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename Clock, typename Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const
+    {
+        throw_if_invalid();
+        return m_state->wait_until(deadline);
+    }
+
+    T get()
+    {
+        throw_if_invalid();
+        auto state = std::move(m_state); // like std::future - the future is invalid after get()
+        return state->get();
+    }
+
+    // Calls observer() inline on the thread that makes the result ready, or at once when it is ready;
+    // the future stays valid - this is the building block of when_all()/when_any()
+    template <typename Observer>
+    void on_ready(Observer&& observer) const
+    {
+        throw_if_invalid();
+        m_state->add_observer(Task{std::forward<Observer>(observer)});
+    }
+
+    // Executor that runs the continuations of this future (nullptr - they run inline, also once the
+    // executor is destroyed: a future may outlive its pool)
+    Executor* executor() const
+    {
+        throw_if_invalid();
+        const auto& link = m_state->link();
+        return link ? link->executor() : nullptr;
+    }
+
+    // Lifetime token of that executor (nullptr - none) for code that waits or schedules work next to the
+    // future, e.g. the combinators: unlike executor() it stays safe to use once the executor is destroyed
+    const std::shared_ptr<detail::ExecutorLink>& executor_link() const
+    {
+        throw_if_invalid();
+        return m_state->link();
+    }
+
+    // Schedules f on the executor of the future once the result is ready and returns the future of its result.
+    // f takes the value (nothing for Future<void>) - then an exception skips f and is passed down the chain -
+    // or the ready Future<T> itself, to handle the exception. Like get(), then() invalidates the future.
+    template <typename F>
+    auto then(F&& f)
+    {
+        throw_if_invalid();
+
+        using Fn = std::decay_t<F>;
+        using ResultT = decltype(call_continuation(std::declval<Fn&>(), m_state));
+
+        auto state = std::move(m_state);
+        Promise<ResultT> promise{state->link()};
+        Future<ResultT> result = promise.get_future();
+
+        Task continuation{[promise = std::move(promise), f = Fn(std::forward<F>(f)), state]() mutable {
+            auto call = [&] { return call_continuation(f, std::move(state)); };
+            promise.set_from(call);
+        }};
+        state->set_continuation(std::move(continuation)); // state owns the continuation until it is dispatched
+
+        return result;
+    }
+
+private:
+    friend class Promise<T>;
+
+    template <typename U>
+    friend class Future;
+
+    template <typename Fn>
+    static auto call_continuation(Fn& f, std::shared_ptr<detail::SharedState<T>> state)
+    {
+        if constexpr (std::is_invocable_v<Fn&, Future<T>>)
+            return f(Future<T>{std::move(state)});
+        else if constexpr (std::is_void_v<T>)
+        {
+            state->get();
+            return f();
+        }
+        else
+            return f(state->get());
+    }
+
+    explicit Future(std::shared_ptr<detail::SharedState<T>> state)
+        : m_state{std::move(state)}
+    {
+    }
+
+    void throw_if_invalid() const
+    {
+        if (!m_state)
+            throw std::future_error{std::future_errc::no_state};
+    }
+
+    std::shared_ptr<detail::SharedState<T>> m_state;
+};
+
+// Future of a task that can be cancelled: a task that has not started yet is skipped (the future then
+// holds std::future_error with broken_promise), a running task sees the request through its std::stop_token
+template <typename T>
+class CancellableFuture : public Future<T>
+{
+public:
+    CancellableFuture() = default;
+
+    CancellableFuture(Future<T> future, std::stop_source source)
+        : Future<T>{std::move(future)}
+        , m_source{std::move(source)}
+    {
+    }
+
+    // false when stop was already requested
+    bool request_stop() noexcept
+    {
+        return m_source.request_stop();
+    }
+
+    bool stop_requested() const noexcept
+    {
+        return m_source.stop_requested();
+    }
+
+    std::stop_token get_stop_token() const noexcept
+    {
+        return m_source.get_token();
+    }
+
+private:
+    std::stop_source m_source{std::nostopstate};
+};
+
+template <typename T>
+class Promise
+{
+public:
+    explicit Promise(Executor* executor = nullptr)
+        : Promise{executor ? executor->link() : nullptr}
+    {
+    }
+
+    explicit Promise(std::shared_ptr<detail::ExecutorLink> link)
+        : m_state{std::allocate_shared<detail::SharedState<T>>(PooledAllocator<detail::SharedState<T>>{}, std::move(link))}
+    {
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    Promise(Promise&& other) noexcept
+        : m_state{std::move(other.m_state)}
+        , m_future_retrieved{other.m_future_retrieved}
+    {
+    }
+
+    Promise& operator=(Promise&& other) noexcept
+    {
+        if (this != &other)
+        {
+            break_promise();
+            m_state = std::move(other.m_state);
+            m_future_retrieved = other.m_future_retrieved;
+        }
+
+        return *this;
+    }
+
+    ~Promise()
+    {
+        break_promise();
+    }
+
+    Future<T> get_future()
+    {
+        throw_if_invalid();
+        if (std::exchange(m_future_retrieved, true))
+            throw std::future_error{std::future_errc::future_already_retrieved};
+
+        return Future<T>{m_state};
+    }
+
+    template <typename... Args>
+    void set_value(Args&&... args)
+    {
+        throw_if_invalid();
+        m_state->set_value(std::forward<Args>(args)...);
+    }
+
+    void set_exception(std::exception_ptr eptr)
+    {
+        throw_if_invalid();
+        m_state->set_exception(eptr);
+    }
+
+    // Invokes callable and stores its result or the exception it throws
+    template <typename Callable>
+    void set_from(Callable& callable)
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                callable();
+                set_value();
+            }
+            else
+            {
+                set_value(callable());
+            }
+        }
+        catch (...)
+        {
+            set_exception(std::current_exception());
+        }
+    }
+
+private:
+    void throw_if_invalid() const
+    {
+        if (!m_state)
+            throw std::future_error{std::future_errc::no_state};
+    }
+
+    // A promise destroyed (e.g. with a dropped task) before it was satisfied fails its future
+    void break_promise() noexcept
+    {
+        if (m_state)
+            m_state->break_promise();
+    }
+
+    std::shared_ptr<detail::SharedState<T>> m_state;
+    bool m_future_retrieved = false;
+};
+
+#endif // FUTURE_HPP
@@ -1,79 +1,21 @@
-#include "thread_safe_queue.hpp"
+#include "task_graph.hpp"
+#include "thread_pool.hpp"
+#include "when.hpp"
 
 #include <cassert>
 #include <chrono>
 #include <functional>
 #include <future>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <ranges>
 #include <string>
 #include <thread>
 #include <vector>
 
 using namespace std::literals;
 
-using Task = std::function<void()>;
-//using Task = folly::Function<void()>;
-
-class ThreadPool
-{
-public:
-    ThreadPool(const unsigned int size = std::thread::hardware_concurrency())
-        : m_size{size}
-    {
-        for (int i = 0; i < size; i++)
-        {
-            m_pool.push_back(std::thread([this] { Run_(); }));
-        }
-    }
-
-    ThreadPool(const ThreadPool&) = delete;
-    ThreadPool& operator=(const ThreadPool&) = delete;
-
-    template <typename Callable>
-    auto submit(Callable&& callable)
-    {
-        using ResultT = decltype(callable());
-        //std::packaged_task<ResultT()> pt{std::forward<Callable>(callable)}; // This doesn't work - pt in noncopyable
-        auto pt = std::make_shared<std::packaged_task<ResultT()>>(std::forward<Callable>(callable));
-        std::future<ResultT> f = pt->get_future();
-
-        m_tasks.push([pt] () mutable { (*pt)(); });
-
-        return f;
-    }
-
-    ~ThreadPool()
-    {
-        for (unsigned int i = 0; i < m_size; ++i)
-        {
-            submit([this] { m_is_done_ = true; });
-        }
-
-        for (auto& thd : m_pool)
-        {
-            if (thd.joinable())
-                thd.join();
-        }
-    }
-
-private:
-    void Run_()
-    {
-        Task task;
-        while (!m_is_done_)
-        {
-            m_tasks.pop(task);
-            task();
-        }
-    }
-
-    const unsigned int m_size;
-    std::vector<std::thread> m_pool;
-    ThreadSafeQueue<Task> m_tasks;
-    std::atomic<bool> m_is_done_{false};
-};
-
 void background_work(size_t id, const std::string& text, std::chrono::milliseconds delay)
 {
     std::cout << "bw#" << id << " has started..." << std::endl;
@@ -111,23 +53,33 @@ int main()
     {
         ThreadPool thd_pool{6};
 
-        thd_pool.submit([] { background_work(1, "Text#1", 100ms); });
-        thd_pool.submit([] { background_work(1, "Text#2", 150ms); });
+        using enum ThreadPool::Priority;
+
+        thd_pool.post(low, [] { background_work(1, "Text#1", 100ms); }); // no future - nothing to allocate for the result
+        thd_pool.post(low, [] { background_work(1, "Text#2", 150ms); });
 
-        for (int i = 3; i < 20; ++i)
-            thd_pool.submit([i]() { background_work(i, "Text#" + std::to_string(i), 150ms); });
+        // one lock acquisition for the whole batch
+        thd_pool.submit_bulk(low, std::views::iota(3, 20) | std::views::transform([](int i) {
+            return [i]() { background_work(i, "Text#" + std::to_string(i), 150ms); };
+        }));
 
         auto f_result_41 = thd_pool.submit([] { return calculate_square(41); });
 
-        std::vector<std::tuple<int, std::future<int>>> fsquares;
-        for (int i = 42; i < 55; ++i)
+        const int first_square = 42;
+        std::vector<Future<int>> fsquares;
+        for (int i = first_square; i < 55; ++i)
         {
-            fsquares.push_back(std::tuple{i, thd_pool.submit([i] { return calculate_square(i); })});
+            fsquares.push_back(thd_pool.submit(high, [i] { return calculate_square(i); })); // not queued behind background work
         }
 
-        for (auto& fs : fsquares)
+        std::cout << "Queue depth - high: " << thd_pool.queue_depth(high)
+                  << "; normal: " << thd_pool.queue_depth(normal)
+                  << "; low: " << thd_pool.queue_depth(low) << "\n";
+
+        // results are reported as soon as they are ready - a slow early task does not hold up the others
+        for (auto [index, square_n] : as_completed(std::move(fsquares)))
         {
-            auto& [n, square_n] = fs;
+            const int n = first_square + static_cast<int>(index);
             try
             {
                 auto result = square_n.get();
@@ -138,6 +90,93 @@ int main()
                 std::cout << n << " : " << e.what() << "\n";
             }
         }
+
+        // each step is queued when the previous one is done - no thread waits in between
+        auto pipeline = thd_pool.submit([] { return calculate_square(7); })
+                            .then([](int square) { return square + 1; })
+                            .then([](int x) { return "Pipeline result: " + std::to_string(x); });
+        std::cout << pipeline.get() << "\n";
+    }
+
+    {
+        ThreadPool graph_pool{4};
+
+        // read -> process(id) x 4 -> merge, declared once and run twice
+        std::vector<int> data;
+        std::vector<long> partial_sums(4);
+        long sum = 0;
+
+        TaskGraph graph;
+        auto read = graph.add_node([&data] {
+            data.resize(100);
+            std::iota(data.begin(), data.end(), 1);
+        });
+        auto merge = graph.add_node([&] { sum = std::accumulate(partial_sums.begin(), partial_sums.end(), 0L); });
+        for (int id = 0; id < 4; ++id)
+        {
+            auto process = graph.add_node([&, id] { partial_sums[id] = std::accumulate(data.begin() + id * 25, data.begin() + (id + 1) * 25, 0L); });
+            graph.add_edge(read, process);
+            graph.add_edge(process, merge);
+        }
+
+        for (int run = 0; run < 2; ++run)
+        {
+            graph.run(graph_pool).get();
+            std::cout << "Graph run #" << run << "; sum: " << sum << "\n";
+        }
+    }
+
+    {
+        ThreadPool timer_pool{2};
+
+        // delays and periods are kept by the timer thread of the pool - workers only run the callables
+        auto heartbeat = timer_pool.submit_every(50ms, [beat = 0]() mutable { std::cout << "Heartbeat #" << ++beat << "\n"; });
+        auto delayed = timer_pool.submit_after(175ms, [] { return std::string{"Delayed task is done"}; });
+
+        std::cout << delayed.get() << "\n";
+        heartbeat.cancel();
+    }
+
+    {
+        ThreadPool ws_pool{6, ThreadPool::Scheduling::work_stealing};
+
+        // tasks submitted from a worker stay in its local deque - idle workers steal them
+        std::vector<Future<std::vector<Future<int>>>> fan_outs;
+        for (int i = 0; i < 6; ++i)
+        {
+            fan_outs.push_back(ws_pool.submit([&ws_pool, i] {
+                std::vector<Future<int>> squares;
+                for (int j = 0; j < 100; ++j)
+                    squares.push_back(ws_pool.submit([x = i * 100 + j] { return x * x; }));
+                return squares;
+            }));
+        }
+
+        long sum = 0;
+        for (auto& fan_out : fan_outs)
+            for (auto& square : fan_out.get())
+                sum += square.get();
+
+        std::cout << "Sum of squares: " << sum << "\n";
+    }
+
+    {
+        ThreadPool elastic_pool{ThreadPool::Options{.min_threads = 2, .max_threads = 8}};
+
+        // blocking tasks (sleeps stand for I/O) stall the pool - it adds threads up to max_threads
+        std::vector<Future<void>> io_tasks;
+        for (int i = 0; i < 16; ++i)
+            io_tasks.push_back(elastic_pool.submit([] { std::this_thread::sleep_for(200ms); }));
+
+        for (auto& f : io_tasks)
+            f.get();
+
+        std::cout << "Elastic pool size after blocking tasks: " << elastic_pool.size() << "\n";
+
+        const auto stats = elastic_pool.snapshot().total();
+        std::cout << "Tasks executed: " << stats.tasks_executed
+                  << "; p99 queue latency: " << std::chrono::duration_cast<std::chrono::milliseconds>(stats.queue_latency.percentile(99)).count() << "ms"
+                  << "; p99 execution time: " << std::chrono::duration_cast<std::chrono::milliseconds>(stats.execution_time.percentile(99)).count() << "ms\n";
     }
 
     std::cout << "Main thread ends..." << std::endl;
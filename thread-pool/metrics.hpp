@@ -0,0 +1,219 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Per-worker ThreadPool instrumentation. Build with THREAD_POOL_METRICS=0 to compile it out -
+// the pool then neither reads the clock nor touches any counter.
+#ifndef THREAD_POOL_METRICS
+#define THREAD_POOL_METRICS 1
+#endif
+
+inline constexpr bool metrics_enabled = THREAD_POOL_METRICS != 0;
+
+// Copy of a LatencyHistogram
+class HistogramSnapshot
+{
+public:
+    // HDR-style layout: values below sub_bucket_count ns are exact, above every power of two
+    // is split into sub_bucket_count linear buckets - the relative error stays below 1/sub_bucket_count
+    static constexpr unsigned int sub_bucket_bits = 3;
+    static constexpr std::uint64_t sub_bucket_count = 1u << sub_bucket_bits;
+    static constexpr size_t bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    static size_t bucket_index(std::uint64_t value)
+    {
+        if (value < sub_bucket_count)
+            return value;
+
+        const unsigned int exponent = std::bit_width(value) - 1;
+        const unsigned int shift = exponent - sub_bucket_bits;
+        return (shift + 1) * sub_bucket_count + ((value >> shift) & (sub_bucket_count - 1));
+    }
+
+    // Highest value that falls into the bucket
+    static std::uint64_t bucket_upper_bound(size_t index)
+    {
+        if (index < sub_bucket_count)
+            return index;
+
+        const unsigned int shift = index / sub_bucket_count - 1;
+        const std::uint64_t lower = (sub_bucket_count + index % sub_bucket_count) << shift;
+        return lower + ((std::uint64_t{1} << shift) - 1);
+    }
+
+    HistogramSnapshot()
+        : m_counts(bucket_count)
+    {
+    }
+
+    std::uint64_t count() const
+    {
+        std::uint64_t total = 0;
+        for (auto c : m_counts)
+            total += c;
+        return total;
+    }
+
+    // Value below which the given percentage (0..100) of recorded values fall, within the bucket resolution
+    std::chrono::nanoseconds percentile(double percent) const
+    {
+        const std::uint64_t total = count();
+        if (total == 0)
+            return std::chrono::nanoseconds::zero();
+
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percent / 100.0 * total)));
+        std::uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= rank)
+                return std::chrono::nanoseconds{bucket_upper_bound(i)};
+        }
+
+        return max();
+    }
+
+    std::chrono::nanoseconds max() const
+    {
+        for (size_t i = bucket_count; i-- > 0;)
+        {
+            if (m_counts[i] > 0)
+                return std::chrono::nanoseconds{bucket_upper_bound(i)};
+        }
+
+        return std::chrono::nanoseconds::zero();
+    }
+
+    const std::vector<std::uint64_t>& counts() const
+    {
+        return m_counts;
+    }
+
+    HistogramSnapshot& operator+=(const HistogramSnapshot& other)
+    {
+        for (size_t i = 0; i < bucket_count; ++i)
+            m_counts[i] += other.m_counts[i];
+        return *this;
+    }
+
+private:
+    friend class LatencyHistogram;
+
+    std::vector<std::uint64_t> m_counts;
+};
+
+// Histogram of durations with a single writer (the owning worker) and any number of readers
+class LatencyHistogram
+{
+public:
+    void record(std::chrono::nanoseconds duration)
+    {
+        const auto value = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0));
+        auto& bucket = m_counts[HistogramSnapshot::bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // single writer - no RMW needed
+    }
+
+    HistogramSnapshot snapshot() const
+    {
+        HistogramSnapshot result;
+        for (size_t i = 0; i < HistogramSnapshot::bucket_count; ++i)
+            result.m_counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, HistogramSnapshot::bucket_count> m_counts{};
+};
+
+struct WorkerStats
+{
+    std::uint64_t tasks_executed = 0;
+    std::uint64_t tasks_stolen = 0;
+    std::chrono::nanoseconds busy_time{0};
+    std::chrono::nanoseconds idle_time{0}; // waiting for work
+    HistogramSnapshot queue_latency;       // enqueue-to-start
+    HistogramSnapshot execution_time;
+
+    WorkerStats& operator+=(const WorkerStats& other)
+    {
+        tasks_executed += other.tasks_executed;
+        tasks_stolen += other.tasks_stolen;
+        busy_time += other.busy_time;
+        idle_time += other.idle_time;
+        queue_latency += other.queue_latency;
+        execution_time += other.execution_time;
+        return *this;
+    }
+};
+
+struct MetricsSnapshot
+{
+    std::vector<WorkerStats> workers; // one entry per worker slot
+
+    WorkerStats total() const
+    {
+        WorkerStats result;
+        for (const auto& worker : workers)
+            result += worker;
+        return result;
+    }
+};
+
+// Counters of one worker - written only by the worker itself, read by snapshot()
+class WorkerMetrics
+{
+public:
+    void record_task(std::chrono::nanoseconds queue_latency, std::chrono::nanoseconds execution_time)
+    {
+        increment(m_tasks_executed, 1);
+        increment(m_busy_ns, execution_time.count());
+        m_queue_latency.record(queue_latency);
+        m_execution_time.record(execution_time);
+    }
+
+    void record_steal()
+    {
+        increment(m_tasks_stolen, 1);
+    }
+
+    void record_idle(std::chrono::nanoseconds idle_time)
+    {
+        increment(m_idle_ns, idle_time.count());
+    }
+
+    WorkerStats snapshot() const
+    {
+        return WorkerStats{
+            m_tasks_executed.load(std::memory_order_relaxed),
+            m_tasks_stolen.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds{m_busy_ns.load(std::memory_order_relaxed)},
+            std::chrono::nanoseconds{m_idle_ns.load(std::memory_order_relaxed)},
+            m_queue_latency.snapshot(),
+            m_execution_time.snapshot()};
+    }
+
+private:
+    template <typename T>
+    static void increment(std::atomic<T>& counter, std::type_identity_t<T> value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> m_tasks_executed{0};
+    std::atomic<std::uint64_t> m_tasks_stolen{0};
+    std::atomic<std::int64_t> m_busy_ns{0};
+    std::atomic<std::int64_t> m_idle_ns{0};
+    LatencyHistogram m_queue_latency;
+    LatencyHistogram m_execution_time;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,302 @@
+#ifndef MPMC_RING_QUEUE_HPP
+#define MPMC_RING_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Bounded lock-free multi-producer/multi-consumer queue (D. Vyukov): a ring of cells, each with a sequence
+// number telling whose turn it is. A producer at position pos may fill the cell when its sequence is pos and
+// publishes the item by storing pos + 1; a consumer may take it when the sequence is pos + 1 and frees the cell
+// for the next lap by storing pos + capacity. Producers and consumers contend only on their own position
+// counter (one CAS per operation) and never touch each other's cells at the same time.
+//
+// try_push/try_pop never block. push/pop are blocking wrappers that sleep on std::atomic::wait when the ring
+// is full/empty; the other side pays for a notification only while somebody sleeps. Like ThreadSafeQueue,
+// after close() pushes fail (try_push returns false, push throws std::runtime_error) and blocking pops drain
+// the items left and then report the queue as closed. close() sets a bit in the enqueue position, so no cell
+// can be claimed afterwards and a blocking pop knows exactly which items are the last ones - it waits for a
+// producer that claimed a cell before close() to publish it instead of losing the item.
+template <typename T>
+class MpmcRingQueue
+{
+    static_assert(std::is_nothrow_move_constructible_v<T>, "a claimed cell must be filled - moving T into it may not throw");
+
+public:
+    // The capacity is rounded up to a power of two (at least 2)
+    explicit MpmcRingQueue(size_t capacity)
+        : m_mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1}
+        , m_cells{std::make_unique<Cell[]>(m_mask + 1)}
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcRingQueue(const MpmcRingQueue&) = delete;
+    MpmcRingQueue& operator=(const MpmcRingQueue&) = delete;
+
+    ~MpmcRingQueue()
+    {
+        const size_t end = m_enqueue_pos.load(std::memory_order_relaxed) & ~closed_bit;
+        for (size_t pos = m_dequeue_pos.load(std::memory_order_relaxed); pos != end; ++pos)
+            m_cells[pos & m_mask].item()->~T();
+    }
+
+    size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    // A snapshot - may be stale by the time it is returned
+    bool empty() const
+    {
+        return !has_item();
+    }
+
+    bool try_push(const T& item)
+    {
+        return try_emplace(item);
+    }
+
+    bool try_push(T&& item)
+    {
+        return try_emplace(std::move(item));
+    }
+
+    // false - the ring is full or closed. When T is nothrow constructible from the arguments they are used
+    // only if the item is pushed; otherwise the item is built before a cell is claimed and then moved into it.
+    template <typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>)
+            return try_emplace_in_place(std::forward<Args>(args)...);
+        else
+            return try_emplace_in_place(T(std::forward<Args>(args)...));
+    }
+
+    bool try_pop(T& item)
+    {
+        std::optional<T> popped = try_pop();
+        if (!popped)
+            return false;
+
+        item = std::move(*popped);
+        return true;
+    }
+
+    std::optional<T> try_pop()
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::intptr_t>(sequence - (pos + 1));
+            if (lag == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (lag < 0)
+                return std::nullopt; // the item at pos is not published yet
+            else
+                pos = m_dequeue_pos.load(std::memory_order_relaxed); // another consumer took the position
+        }
+
+        T* item = cell->item();
+        std::optional<T> popped{std::move(*item)};
+        item->~T();
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+        wake(m_push_signal, m_producers_asleep);
+        return popped;
+    }
+
+    // Waits for room in the ring; throws std::runtime_error when the queue is closed
+    void push(const T& item)
+    {
+        emplace(item);
+    }
+
+    void push(T&& item)
+    {
+        emplace(std::move(item));
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args&&...>)
+        {
+            emplace(T(std::forward<Args>(args)...));
+        }
+        else
+        {
+            // a failed attempt leaves the arguments untouched, so forwarding them again is fine
+            while (!try_emplace_in_place(std::forward<Args>(args)...))
+            {
+                if (is_closed())
+                    throw std::runtime_error{"MpmcRingQueue: push to a closed queue"};
+
+                wait(m_push_signal, m_producers_asleep, [this] { return has_room() || is_closed(); });
+            }
+        }
+    }
+
+    // false - the queue is closed and empty
+    bool pop(T& item)
+    {
+        std::optional<T> popped = pop();
+        if (!popped)
+            return false;
+
+        item = std::move(*popped);
+        return true;
+    }
+
+    // Waits for an item; empty - the queue is closed and empty
+    std::optional<T> pop()
+    {
+        while (true)
+        {
+            if (auto item = try_pop())
+                return item;
+
+            const size_t enqueue_pos = m_enqueue_pos.load();
+            if (enqueue_pos & closed_bit)
+            {
+                // the enqueue position is final: every cell before it has been claimed and will be published
+                if (m_dequeue_pos.load() == (enqueue_pos & ~closed_bit))
+                    return std::nullopt;
+
+                std::this_thread::yield(); // a producer is between claiming its cell and publishing the item
+                continue;
+            }
+
+            wait(m_pop_signal, m_consumers_asleep, [this] { return has_item() || is_closed(); });
+        }
+    }
+
+    // Wakes up all blocked producers and consumers; idempotent
+    void close()
+    {
+        m_enqueue_pos.fetch_or(closed_bit);
+
+        m_push_signal.fetch_add(1);
+        m_push_signal.notify_all();
+        m_pop_signal.fetch_add(1);
+        m_pop_signal.notify_all();
+    }
+
+    bool is_closed() const
+    {
+        return (m_enqueue_pos.load() & closed_bit) != 0;
+    }
+
+private:
+    // Set in the enqueue position by close() - a producer's CAS on the position fails from then on
+    static constexpr size_t closed_bit = size_t{1} << (std::numeric_limits<size_t>::digits - 1);
+
+    struct Cell
+    {
+        T* item() noexcept
+        {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        std::atomic<size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    // Claims the cell at the enqueue position and constructs the item in it - the construction must not throw
+    template <typename... Args>
+    bool try_emplace_in_place(Args&&... args)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            if (pos & closed_bit)
+                return false;
+
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::intptr_t>(sequence - pos);
+            if (lag == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (lag < 0)
+                return false; // the cell still holds the item of the previous lap
+            else
+                pos = m_enqueue_pos.load(std::memory_order_relaxed); // another producer took the position
+        }
+
+        ::new (cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        wake(m_pop_signal, m_consumers_asleep);
+        return true;
+    }
+
+    bool has_item() const
+    {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    bool has_room() const
+    {
+        const size_t pos = m_enqueue_pos.load(std::memory_order_relaxed) & ~closed_bit;
+        return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) == pos;
+    }
+
+    // A sleeper raises the flag and re-checks the ring; the other side publishes a cell and checks the flag.
+    // The seq_cst fences on both sides guarantee that one of them sees the other: either the sleeper finds
+    // the cell or the signal is bumped and the sleeper is woken. The waker lowers the flag, so a run of pushes
+    // (pops) pays for one notification however long the woken threads take to get scheduled.
+    template <typename Ready>
+    static void wait(std::atomic<std::uint32_t>& signal, std::atomic<bool>& is_asleep, Ready is_ready)
+    {
+        const std::uint32_t observed = signal.load();
+        is_asleep.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!is_ready())
+            signal.wait(observed);
+    }
+
+    static void wake(std::atomic<std::uint32_t>& signal, std::atomic<bool>& is_asleep)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!is_asleep.load(std::memory_order_relaxed) || !is_asleep.exchange(false))
+            return;
+
+        signal.fetch_add(1);
+        signal.notify_all();
+    }
+
+    const size_t m_mask;
+    const std::unique_ptr<Cell[]> m_cells;
+
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0}; // producers and consumers work on separate cache lines
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+
+    alignas(64) std::atomic<std::uint32_t> m_push_signal{0}; // bumped when a blocked producer may find room
+    std::atomic<std::uint32_t> m_pop_signal{0};  // bumped when a blocked consumer may find an item
+    std::atomic<bool> m_producers_asleep{false};
+    std::atomic<bool> m_consumers_asleep{false};
+};
+
+#endif // MPMC_RING_QUEUE_HPP
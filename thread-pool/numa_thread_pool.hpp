@@ -0,0 +1,86 @@
+#ifndef NUMA_THREAD_POOL_HPP
+#define NUMA_THREAD_POOL_HPP
+
+#include "thread_pool.hpp"
+#include "topology.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// One ThreadPool per NUMA node with its workers pinned to the CPUs of the node.
+// Tasks submitted with a node hint run on that node - next to the memory the caller allocated there.
+// Throws std::invalid_argument for an empty list of nodes.
+class NumaThreadPool
+{
+public:
+    explicit NumaThreadPool(ThreadPool::Scheduling scheduling = ThreadPool::Scheduling::shared_queue,
+        std::vector<NumaNode> nodes = numa_topology())
+        : m_nodes{std::move(nodes)}
+    {
+        if (m_nodes.empty())
+            throw std::invalid_argument{"NumaThreadPool: no NUMA nodes"};
+
+        for (const auto& node : m_nodes)
+        {
+            const auto threads = static_cast<unsigned int>(node.cpus.size());
+            m_pools.push_back(std::make_unique<ThreadPool>(
+                ThreadPool::Options{.min_threads = threads, .max_threads = threads, .scheduling = scheduling, .cpus = node.cpus}));
+        }
+    }
+
+    size_t node_count() const
+    {
+        return m_nodes.size();
+    }
+
+    const NumaNode& node(size_t node_index) const
+    {
+        return m_nodes.at(node_index);
+    }
+
+    ThreadPool& pool(size_t node_index)
+    {
+        return *m_pools.at(node_index);
+    }
+
+    // Index of the node the calling thread is running on (0 when unknown)
+    size_t current_node() const
+    {
+        const int cpu = current_cpu();
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if (std::ranges::find(m_nodes[i].cpus, cpu) != m_nodes[i].cpus.end())
+                return i;
+        }
+
+        return 0;
+    }
+
+    // Runs on the node of the calling thread
+    template <typename Callable>
+    auto submit(Callable&& callable)
+    {
+        return submit(current_node(), std::forward<Callable>(callable));
+    }
+
+    // node_hint is an index of node(); out of range hints wrap around
+    template <typename Callable>
+    auto submit(size_t node_hint, Callable&& callable)
+    {
+        return m_pools[node_hint % m_pools.size()]->submit(std::forward<Callable>(callable));
+    }
+
+    template <typename Callable>
+    auto submit(size_t node_hint, ThreadPool::Priority priority, Callable&& callable)
+    {
+        return m_pools[node_hint % m_pools.size()]->submit(priority, std::forward<Callable>(callable));
+    }
+
+private:
+    std::vector<NumaNode> m_nodes;
+    std::vector<std::unique_ptr<ThreadPool>> m_pools;
+};
+
+#endif // NUMA_THREAD_POOL_HPP
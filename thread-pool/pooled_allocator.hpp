@@ -0,0 +1,146 @@
+#ifndef POOLED_ALLOCATOR_HPP
+#define POOLED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Allocator recycling small blocks through per-thread freelists - no locks, no atomics.
+// A block freed on another thread than the one that allocated it joins the freelist of the freeing thread;
+// a freelist keeps at most max_cached_blocks blocks, the rest goes back to operator delete, so memory
+// migrating from producers to consumers stays bounded.
+namespace detail
+{
+    inline constexpr std::size_t block_granularity = 64;
+    inline constexpr std::size_t size_class_count = 16; // blocks of 64, 128, ..., 1024 bytes
+    inline constexpr std::size_t max_pooled_size = block_granularity * size_class_count;
+    inline constexpr std::size_t max_cached_blocks = 512;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock* head = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Trivially destructible, so it is usable while other thread_local objects are destroyed
+    struct BlockCache
+    {
+        FreeList lists[size_class_count];
+        bool is_registered = false;
+        bool is_destroyed = false; // blocks freed during thread exit go straight to operator delete
+    };
+
+    inline constinit thread_local BlockCache tl_block_cache;
+
+    inline void release_blocks(FreeList& list) noexcept
+    {
+        while (list.head)
+            ::operator delete(std::exchange(list.head, list.head->next));
+        list.size = 0;
+    }
+
+    // Frees the cached blocks of a thread when it exits
+    struct BlockCacheFlusher
+    {
+        ~BlockCacheFlusher()
+        {
+            for (auto& list : tl_block_cache.lists)
+                release_blocks(list);
+            tl_block_cache.is_destroyed = true;
+        }
+    };
+
+    inline void register_block_cache() noexcept
+    {
+        tl_block_cache.is_registered = true;
+        static thread_local BlockCacheFlusher flusher;
+    }
+
+    inline std::size_t size_class(std::size_t bytes) noexcept
+    {
+        return (bytes + block_granularity - 1) / block_granularity - 1;
+    }
+
+    inline void* allocate_block(std::size_t bytes)
+    {
+        if (bytes > max_pooled_size)
+            return ::operator new(bytes);
+
+        // every small block gets the full size of its class - it may be freed into a live freelist later
+        const std::size_t index = size_class(bytes);
+        if (tl_block_cache.is_destroyed)
+            return ::operator new((index + 1) * block_granularity);
+
+        FreeList& list = tl_block_cache.lists[index];
+        if (list.head)
+        {
+            --list.size;
+            return std::exchange(list.head, list.head->next);
+        }
+
+        if (!tl_block_cache.is_registered)
+            register_block_cache();
+
+        return ::operator new((index + 1) * block_granularity);
+    }
+
+    inline void deallocate_block(void* ptr, std::size_t bytes) noexcept
+    {
+        if (bytes > max_pooled_size || tl_block_cache.is_destroyed)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        if (!tl_block_cache.is_registered)
+            register_block_cache();
+
+        FreeList& list = tl_block_cache.lists[size_class(bytes)];
+        if (list.size == max_cached_blocks)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        list.head = ::new (ptr) FreeBlock{list.head};
+        ++list.size;
+    }
+} // namespace detail
+
+template <typename T>
+class PooledAllocator
+{
+public:
+    using value_type = T;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned types are not pooled");
+        return static_cast<T*>(detail::allocate_block(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        detail::deallocate_block(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+#endif // POOLED_ALLOCATOR_HPP
@@ -0,0 +1,136 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable with inline (small-buffer) storage.
+// Unlike std::function it accepts move-only callables (std::packaged_task, lambdas owning a std::promise...),
+// and callables up to buffer_size bytes are stored without touching the heap.
+class Task
+{
+public:
+    static constexpr std::size_t buffer_size = 64 - sizeof(void*); // sizeof(Task) == one cache line
+
+    Task() noexcept = default;
+
+    Task(std::nullptr_t) noexcept
+    {
+    }
+
+    template <typename Callable>
+        requires(!std::same_as<std::remove_cvref_t<Callable>, Task> && std::invocable<std::decay_t<Callable>&>)
+    Task(Callable&& callable)
+    {
+        using F = std::decay_t<Callable>;
+
+        if constexpr (fits_inline<F>)
+        {
+            ::new (static_cast<void*>(m_storage)) F(std::forward<Callable>(callable));
+            m_vtable = &inline_vtable<F>;
+        }
+        else
+        {
+            ::new (static_cast<void*>(m_storage)) F*(new F(std::forward<Callable>(callable)));
+            m_vtable = &heap_vtable<F>;
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : m_vtable{other.m_vtable}
+    {
+        if (m_vtable)
+        {
+            m_vtable->move(m_storage, other.m_storage);
+            other.m_vtable = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+
+            if (other.m_vtable)
+            {
+                other.m_vtable->move(m_storage, other.m_storage);
+                m_vtable = std::exchange(other.m_vtable, nullptr);
+            }
+        }
+
+        return *this;
+    }
+
+    Task& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    ~Task()
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_vtable != nullptr;
+    }
+
+    void operator()()
+    {
+        if (!m_vtable)
+            throw std::bad_function_call{};
+
+        m_vtable->invoke(m_storage);
+    }
+
+    // true when a callable of type F is stored without a heap allocation
+    template <typename F>
+    static constexpr bool fits_inline = sizeof(F) <= buffer_size && alignof(F) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible_v<F>;
+
+private:
+    struct VTable
+    {
+        void (*invoke)(void* storage);
+        void (*move)(void* dest, void* src) noexcept; // move-constructs into dest and destroys src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr VTable inline_vtable{
+        [](void* storage) { std::invoke(*static_cast<F*>(storage)); },
+        [](void* dest, void* src) noexcept {
+            ::new (dest) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* storage) noexcept { static_cast<F*>(storage)->~F(); }};
+
+    template <typename F>
+    static constexpr VTable heap_vtable{
+        [](void* storage) { std::invoke(**static_cast<F**>(storage)); },
+        [](void* dest, void* src) noexcept { ::new (dest) F*(*static_cast<F**>(src)); },
+        [](void* storage) noexcept { delete *static_cast<F**>(storage); }};
+
+    void reset() noexcept
+    {
+        if (m_vtable)
+            std::exchange(m_vtable, nullptr)->destroy(m_storage);
+    }
+
+    alignas(std::max_align_t) std::byte m_storage[buffer_size];
+    const VTable* m_vtable = nullptr;
+};
+
+static_assert(sizeof(Task) == 64);
+
+#endif // TASK_HPP
@@ -0,0 +1,283 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include "future.hpp"
+#include "task.hpp"
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// DAG of void() nodes declared once and run any number of times:
+//
+//   TaskGraph graph;
+//   auto read = graph.add_node([&] { data.read(); });
+//   auto merge = graph.add_node([&] { data.merge(); });
+//   for (int id = 0; id < 4; ++id)
+//   {
+//       auto process = graph.add_node([&, id] { data.process(id); });
+//       graph.add_edge(read, process);
+//       graph.add_edge(process, merge);
+//   }
+//   graph.run(pool).get();
+//
+// Every node keeps an atomic counter of unfinished inputs; the thread that finishes the last input
+// of a node hands the node to the executor. A run allocates nothing but the shared state of its future -
+// the counters are rearmed by the nodes themselves and the list of roots is built when the graph changes.
+class TaskGraph
+{
+public:
+    using NodeId = size_t;
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    template <typename Callable>
+        requires std::invocable<std::decay_t<Callable>&>
+    NodeId add_node(Callable&& body)
+    {
+        throw_if_running();
+
+        m_nodes.emplace_back(Task{std::forward<Callable>(body)});
+        m_is_modified = true;
+        return m_nodes.size() - 1;
+    }
+
+    // to starts after from has finished
+    void add_edge(NodeId from, NodeId to)
+    {
+        throw_if_running();
+
+        Node& predecessor = m_nodes.at(from);
+        Node& successor = m_nodes.at(to);
+        predecessor.successors.push_back(to);
+        ++successor.dependency_count;
+        successor.pending.store(successor.dependency_count, std::memory_order_relaxed);
+        m_is_modified = true;
+    }
+
+    size_t node_count() const
+    {
+        return m_nodes.size();
+    }
+
+    // Starts the roots on the executor; the future is ready when every node has finished.
+    // After the first exception the remaining nodes are skipped and the future holds the exception;
+    // nodes dropped by a shut down executor break the promise. The graph must outlive the run and
+    // may not be modified or run again until the future is ready. Throws std::logic_error for a cycle.
+    Future<void> run(Executor& executor)
+    {
+        if (m_is_running.exchange(true))
+            throw std::logic_error{"TaskGraph: run while running"};
+
+        try
+        {
+            if (m_is_modified)
+                find_roots();
+        }
+        catch (...)
+        {
+            m_is_running.store(false);
+            throw;
+        }
+
+        Promise<void> promise{&executor};
+        auto result = promise.get_future();
+
+        if (m_nodes.empty())
+        {
+            m_is_running.store(false);
+            promise.set_value();
+            return result;
+        }
+
+        m_executor = &executor;
+        m_promise.emplace(std::move(promise));
+        m_exception = nullptr;
+        m_is_failed.store(false, std::memory_order_relaxed);
+        m_nodes_left.store(m_nodes.size(), std::memory_order_relaxed);
+
+        for (NodeId root : m_roots)
+            dispatch(root);
+
+        return result;
+    }
+
+    bool is_running() const
+    {
+        return m_is_running.load();
+    }
+
+private:
+    struct Node
+    {
+        explicit Node(Task body)
+            : body{std::move(body)}
+        {
+        }
+
+        Task body;
+        std::vector<NodeId> successors;
+        size_t dependency_count = 0;
+        std::atomic<size_t> pending{0}; // unfinished inputs in the current run
+    };
+
+    // Queued node; destroyed unrun (dropped by a shut down executor) it completes the node as failed,
+    // so the run still finishes
+    class NodeRun
+    {
+    public:
+        NodeRun(TaskGraph* graph, NodeId id) noexcept
+            : m_graph{graph}
+            , m_id{id}
+        {
+        }
+
+        NodeRun(NodeRun&& other) noexcept
+            : m_graph{std::exchange(other.m_graph, nullptr)}
+            , m_id{other.m_id}
+        {
+        }
+
+        NodeRun& operator=(NodeRun&&) = delete;
+
+        ~NodeRun()
+        {
+            if (m_graph)
+                m_graph->finish_node(m_id, std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+        }
+
+        void operator()()
+        {
+            std::exchange(m_graph, nullptr)->run_node(m_id);
+        }
+
+    private:
+        TaskGraph* m_graph;
+        NodeId m_id;
+    };
+
+    void throw_if_running() const
+    {
+        if (m_is_running.load())
+            throw std::logic_error{"TaskGraph: modified while running"};
+    }
+
+    // Kahn's algorithm - collects the roots and checks that every node is reachable from them
+    void find_roots()
+    {
+        std::vector<size_t> in_degree(m_nodes.size());
+        std::vector<NodeId> ready;
+        for (NodeId id = 0; id < m_nodes.size(); ++id)
+        {
+            in_degree[id] = m_nodes[id].dependency_count;
+            if (in_degree[id] == 0)
+                ready.push_back(id);
+        }
+
+        std::vector<NodeId> roots = ready;
+        size_t visited = 0;
+        while (!ready.empty())
+        {
+            const NodeId id = ready.back();
+            ready.pop_back();
+            ++visited;
+
+            for (NodeId successor : m_nodes[id].successors)
+            {
+                if (--in_degree[successor] == 0)
+                    ready.push_back(successor);
+            }
+        }
+
+        if (visited != m_nodes.size())
+            throw std::logic_error{"TaskGraph: cycle"};
+
+        m_roots = std::move(roots);
+        m_is_modified = false;
+    }
+
+    void dispatch(NodeId id)
+    {
+        m_executor->execute(NodeRun{this, id});
+    }
+
+    void run_node(NodeId id)
+    {
+        std::exception_ptr exception;
+        if (!m_is_failed.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                m_nodes[id].body();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+        }
+
+        finish_node(id, std::move(exception));
+    }
+
+    void finish_node(NodeId id, std::exception_ptr exception)
+    {
+        Node& node = m_nodes[id];
+        node.pending.store(node.dependency_count, std::memory_order_relaxed); // all inputs are done - rearm for the next run
+
+        if (exception)
+        {
+            std::lock_guard lk{m_mtx_exception};
+            if (!m_exception)
+                m_exception = std::move(exception);
+            m_is_failed.store(true, std::memory_order_relaxed);
+        }
+
+        for (NodeId successor : node.successors)
+        {
+            if (m_nodes[successor].pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                dispatch(successor);
+        }
+
+        if (m_nodes_left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            finish_run();
+    }
+
+    // Called by the thread that finished the last node - the graph is not touched after is_running() turns false
+    void finish_run()
+    {
+        Promise<void> promise = std::move(*m_promise);
+        m_promise.reset();
+        std::exception_ptr exception = std::exchange(m_exception, nullptr);
+        m_is_running.store(false);
+
+        if (exception)
+            promise.set_exception(std::move(exception));
+        else
+            promise.set_value();
+    }
+
+    std::deque<Node> m_nodes; // stable addresses - nodes hold atomics
+    std::vector<NodeId> m_roots;
+    bool m_is_modified = false;
+
+    std::atomic<bool> m_is_running{false};
+    Executor* m_executor = nullptr;
+    std::optional<Promise<void>> m_promise;
+    std::atomic<size_t> m_nodes_left{0};
+    std::atomic<bool> m_is_failed{false};
+    std::mutex m_mtx_exception;
+    std::exception_ptr m_exception;
+};
+
+#endif // TASK_GRAPH_HPP
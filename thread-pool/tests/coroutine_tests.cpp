@@ -0,0 +1,203 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "coroutine.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+namespace
+{
+    coro::Task<int> answer()
+    {
+        co_return 42;
+    }
+
+    coro::Task<string> twice(coro::Task<int> inner)
+    {
+        const int value = co_await std::move(inner);
+        co_return to_string(value * 2);
+    }
+
+    coro::Task<int> fails()
+    {
+        throw runtime_error{"Error#3"};
+        co_return 0;
+    }
+
+    coro::Task<thread::id> thread_of(ThreadPool& pool)
+    {
+        co_await pool.schedule();
+        co_return this_thread::get_id();
+    }
+
+    coro::Task<long> sum_squares(ThreadPool& pool, int n)
+    {
+        vector<coro::Task<long>> parts;
+        for (int i = 0; i < n; ++i)
+        {
+            parts.push_back([](ThreadPool& pool, long x) -> coro::Task<long> {
+                co_await pool.schedule();
+                co_return x * x;
+            }(pool, i));
+        }
+
+        long sum = 0;
+        for (long square : co_await coro::when_all(std::move(parts)))
+            sum += square;
+        co_return sum;
+    }
+} // namespace
+
+TEST_CASE("coro::Task")
+{
+    SECTION("task is started lazily by co_await")
+    {
+        bool started = false;
+        auto task = [](bool& started) -> coro::Task<int> { started = true; co_return 1; }(started); // no captures - the closure dies first
+
+        REQUIRE_FALSE(started);
+        REQUIRE(coro::sync_wait(std::move(task)) == 1);
+        REQUIRE(started);
+    }
+
+    SECTION("awaiting a task returns its result")
+    {
+        REQUIRE(coro::sync_wait(twice(answer())) == "84");
+    }
+
+    SECTION("exception is passed to the awaiting coroutine")
+    {
+        REQUIRE_THROWS_AS(coro::sync_wait(twice(fails())), runtime_error);
+    }
+
+    SECTION("void task")
+    {
+        int counter = 0;
+        coro::sync_wait([](int& counter) -> coro::Task<> { ++counter; co_return; }(counter));
+
+        REQUIRE(counter == 1);
+    }
+
+    SECTION("long chains of awaits do not grow the stack")
+    {
+        auto chain = [](auto& self, int depth) -> coro::Task<int> {
+            if (depth == 0)
+                co_return 0;
+            co_return 1 + co_await self(self, depth - 1);
+        };
+
+        REQUIRE(coro::sync_wait(chain(chain, 10'000)) == 10'000);
+    }
+}
+
+TEST_CASE("ThreadPool - coroutines")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{2, scheduling};
+
+    SECTION("schedule moves the coroutine to a worker")
+    {
+        REQUIRE(coro::sync_wait(thread_of(pool)) != this_thread::get_id());
+    }
+
+    SECTION("fan-out with when_all")
+    {
+        REQUIRE(coro::sync_wait(sum_squares(pool, 100)) == 328'350);
+    }
+
+    SECTION("when_all rethrows the first exception after all tasks are done")
+    {
+        atomic<int> completed{0};
+        vector<coro::Task<int>> tasks;
+        for (int i = 0; i < 10; ++i)
+        {
+            tasks.push_back([](ThreadPool& pool, int i, atomic<int>& completed) -> coro::Task<int> {
+                co_await pool.schedule();
+                ++completed;
+                if (i % 3 == 0)
+                    throw runtime_error{"Error#" + to_string(i)};
+                co_return i;
+            }(pool, i, completed));
+        }
+
+        REQUIRE_THROWS_WITH(coro::sync_wait(coro::when_all(std::move(tasks))), "Error#0");
+        REQUIRE(completed == 10);
+    }
+
+    SECTION("awaiting a pool future suspends the coroutine")
+    {
+        ThreadPool single{1, scheduling};
+
+        auto f = coro::spawn([](ThreadPool& pool) -> coro::Task<int> {
+            co_await pool.schedule();
+            // the only worker is released while the nested task waits in the queue
+            int nested = co_await pool.submit([] { return 41; });
+            co_return nested + 1;
+        }(single));
+
+        REQUIRE(f.get() == 42);
+    }
+
+    SECTION("spawned coroutine completes a future")
+    {
+        auto f = coro::spawn(thread_of(pool), &pool);
+
+        REQUIRE(f.then([](thread::id id) { return id != thread::id{}; }).get());
+    }
+
+    SECTION("awaiting a future that outlives its pool resumes inline")
+    {
+        Promise<int> promise;
+        Future<int> awaited;
+        {
+            ThreadPool short_lived{1, scheduling};
+            promise = Promise<int>{&short_lived};
+            awaited = promise.get_future();
+        }
+
+        auto f = coro::spawn([](Future<int> awaited) -> coro::Task<pair<int, thread::id>> {
+            const int value = co_await std::move(awaited);
+            co_return pair{value, this_thread::get_id()};
+        }(std::move(awaited)));
+        promise.set_value(42);
+
+        auto [value, thread_id] = f.get();
+        REQUIRE(value == 42);
+        REQUIRE(thread_id == this_thread::get_id());
+    }
+
+    SECTION("schedule on a shut down pool throws")
+    {
+        pool.shutdown();
+
+        REQUIRE_THROWS_AS(coro::sync_wait(thread_of(pool)), std::runtime_error);
+    }
+
+    SECTION("coroutine dropped by abort is resumed with broken_promise")
+    {
+        std::promise<void> gate;
+        auto opened = gate.get_future().share();
+        std::latch started{2};
+        for (int i = 0; i < 2; ++i)
+            pool.submit([opened, &started] { started.count_down(); opened.wait(); });
+        started.wait();
+
+        auto f = coro::spawn(thread_of(pool));
+
+        thread releaser{[&gate] { this_thread::sleep_for(10ms); gate.set_value(); }};
+        pool.shutdown(ThreadPool::ShutdownMode::abort);
+        releaser.join();
+
+        REQUIRE_THROWS_AS(f.get(), future_error);
+    }
+}
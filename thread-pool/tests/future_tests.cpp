@@ -0,0 +1,158 @@
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "catch.hpp"
+
+#include "future.hpp"
+
+using namespace std;
+
+TEST_CASE("Future & Promise")
+{
+    Promise<string> p;
+    Future<string> f = p.get_future();
+
+    SECTION("future is valid and not ready after creation")
+    {
+        REQUIRE(f.valid());
+        REQUIRE_FALSE(f.is_ready());
+        REQUIRE(f.wait_for(1ms) == future_status::timeout);
+    }
+
+    SECTION("get returns value set by promise")
+    {
+        thread thd{[&p] { p.set_value("text"); }};
+
+        REQUIRE(f.get() == "text");
+        REQUIRE_FALSE(f.valid());
+
+        thd.join();
+    }
+
+    SECTION("get rethrows exception set by promise")
+    {
+        p.set_exception(make_exception_ptr(runtime_error("Error#3")));
+
+        REQUIRE_THROWS_AS(f.get(), runtime_error);
+    }
+
+    SECTION("future is broken when promise is destroyed unsatisfied")
+    {
+        {
+            Promise<string> dropped = std::move(p);
+        }
+
+        REQUIRE_THROWS_MATCHES(f.get(), future_error, Catch::Predicate<future_error>([](const future_error& e) { return e.code() == future_errc::broken_promise; }));
+    }
+
+    SECTION("future can be retrieved only once")
+    {
+        REQUIRE_THROWS_AS(p.get_future(), future_error);
+    }
+
+    SECTION("promise can be satisfied only once")
+    {
+        p.set_value("one");
+
+        REQUIRE_THROWS_AS(p.set_value("two"), future_error);
+    }
+}
+
+TEST_CASE("Future<void>")
+{
+    Promise<void> p;
+    Future<void> f = p.get_future();
+
+    p.set_value();
+
+    REQUIRE(f.is_ready());
+    REQUIRE_NOTHROW(f.get());
+}
+
+TEST_CASE("Future::then")
+{
+    Promise<int> p;
+    Future<int> f = p.get_future();
+
+    SECTION("continuation attached before the value runs when the value is set")
+    {
+        auto g = f.then([](int x) { return to_string(x); });
+
+        REQUIRE_FALSE(f.valid());
+        REQUIRE_FALSE(g.is_ready());
+
+        p.set_value(42);
+
+        REQUIRE(g.get() == "42");
+    }
+
+    SECTION("continuation attached to a ready future runs at once")
+    {
+        p.set_value(1);
+
+        auto g = f.then([](int x) { return x + 1; });
+
+        REQUIRE(g.get() == 2);
+    }
+
+    SECTION("exception skips value continuations down the chain")
+    {
+        bool called = false;
+        auto g = f.then([&](int x) { called = true; return x * 2; }).then([&](int x) { called = true; return x + 1; });
+
+        p.set_exception(make_exception_ptr(runtime_error{"Error#3"}));
+
+        REQUIRE_THROWS_AS(g.get(), runtime_error);
+        REQUIRE_FALSE(called);
+    }
+
+    SECTION("continuation taking the future can handle the exception")
+    {
+        auto g = f.then([](Future<int> r) {
+            try
+            {
+                return r.get();
+            }
+            catch (const runtime_error&)
+            {
+                return -1;
+            }
+        });
+
+        p.set_exception(make_exception_ptr(runtime_error{"Error#3"}));
+
+        REQUIRE(g.get() == -1);
+    }
+
+    SECTION("exception thrown by a continuation is passed down")
+    {
+        auto g = f.then([](int) -> int { throw runtime_error{"Error"}; }).then([](int x) { return x; });
+
+        p.set_value(1);
+
+        REQUIRE_THROWS_AS(g.get(), runtime_error);
+    }
+
+    SECTION("broken promise is passed down")
+    {
+        auto g = f.then([](int x) { return x; });
+
+        p = Promise<int>{};
+
+        REQUIRE_THROWS_AS(g.get(), future_error);
+    }
+
+    SECTION("void continuations")
+    {
+        int result = 0;
+        auto g = f.then([&](int x) { result = x; }).then([&] { result *= 2; });
+
+        p.set_value(21);
+        g.get();
+
+        REQUIRE(result == 42);
+    }
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "metrics.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+TEST_CASE("LatencyHistogram")
+{
+    LatencyHistogram histogram;
+
+    SECTION("small values are recorded exactly")
+    {
+        for (int i = 0; i < 8; ++i)
+            histogram.record(chrono::nanoseconds{i});
+
+        auto snapshot = histogram.snapshot();
+
+        REQUIRE(snapshot.count() == 8);
+        REQUIRE(snapshot.max() == 7ns);
+        REQUIRE(snapshot.percentile(50) == 3ns);
+    }
+
+    SECTION("large values are recorded within bucket resolution")
+    {
+        for (auto value : {1'000ns, 10'000ns, 1'000'000ns, 1'000'000'000ns})
+        {
+            LatencyHistogram h;
+            h.record(value);
+            auto recorded = h.snapshot().max();
+
+            REQUIRE(recorded >= value);
+            REQUIRE(recorded.count() <= value.count() + value.count() / 8);
+        }
+    }
+
+    SECTION("percentiles")
+    {
+        for (int i = 0; i < 99; ++i)
+            histogram.record(100ns);
+        histogram.record(1ms);
+
+        auto snapshot = histogram.snapshot();
+
+        REQUIRE(snapshot.percentile(50) < 120ns);
+        REQUIRE(snapshot.percentile(99) < 120ns);
+        REQUIRE(snapshot.percentile(100) >= 1ms);
+    }
+
+    SECTION("empty histogram")
+    {
+        REQUIRE(histogram.snapshot().count() == 0);
+        REQUIRE(histogram.snapshot().percentile(99) == 0ns);
+    }
+
+    SECTION("bucket bounds are contiguous")
+    {
+        for (size_t i = 1; i < HistogramSnapshot::bucket_count; ++i)
+            REQUIRE(HistogramSnapshot::bucket_index(HistogramSnapshot::bucket_upper_bound(i - 1) + 1) == i);
+    }
+}
+
+TEST_CASE("ThreadPool - metrics")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{2, scheduling};
+
+    SECTION("snapshot has an entry per worker")
+    {
+        REQUIRE(pool.snapshot().workers.size() == 2);
+    }
+
+    if constexpr (metrics_enabled)
+    {
+        SECTION("executed tasks are counted with their latencies")
+        {
+            vector<Future<void>> fs;
+            for (int i = 0; i < 100; ++i)
+                fs.push_back(pool.submit([] { this_thread::sleep_for(100us); }));
+            for (auto& f : fs)
+                f.get();
+            pool.shutdown(); // waits until the last counters are stored
+
+            auto total = pool.snapshot().total();
+
+            REQUIRE(total.tasks_executed == 100);
+            REQUIRE(total.execution_time.count() == 100);
+            REQUIRE(total.queue_latency.count() == 100);
+            REQUIRE(total.execution_time.percentile(50) >= 100us);
+            REQUIRE(total.busy_time >= 100 * 100us);
+        }
+
+        SECTION("idle time is accumulated")
+        {
+            this_thread::sleep_for(10ms);
+            pool.submit([] {}).get();
+            pool.shutdown();
+
+            REQUIRE(pool.snapshot().total().idle_time > 0ns);
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "mpmc_ring_queue.hpp"
+
+using namespace std;
+
+TEST_CASE("MpmcRingQueue")
+{
+    MpmcRingQueue<string> q{4};
+
+    SECTION("capacity is rounded up to a power of two")
+    {
+        REQUIRE(q.capacity() == 4);
+        REQUIRE(MpmcRingQueue<int>{5}.capacity() == 8);
+        REQUIRE(MpmcRingQueue<int>{1}.capacity() == 2);
+    }
+
+    SECTION("is empty after creation")
+    {
+        REQUIRE(q.empty());
+        REQUIRE_FALSE(q.try_pop().has_value());
+    }
+
+    SECTION("pops items in FIFO order")
+    {
+        REQUIRE(q.try_push("one"));
+        REQUIRE(q.try_push(string{"two"}));
+        REQUIRE(q.try_emplace(3, 'x'));
+
+        string item;
+        REQUIRE(q.try_pop(item));
+        REQUIRE(item == "one");
+        REQUIRE(q.try_pop() == "two");
+        REQUIRE(q.pop() == "xxx");
+        REQUIRE(q.empty());
+    }
+
+    SECTION("try_push fails when the ring is full")
+    {
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(q.try_push(to_string(i)));
+
+        REQUIRE_FALSE(q.try_push("overflow"));
+
+        REQUIRE(q.try_pop() == "0");
+        REQUIRE(q.try_push("4"));
+    }
+
+    SECTION("cells are reused across laps")
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE(q.try_push(to_string(i)));
+            REQUIRE(q.try_pop() == to_string(i));
+        }
+    }
+
+    SECTION("items left in the ring are destroyed with it")
+    {
+        auto item = make_shared<int>(1);
+        {
+            MpmcRingQueue<shared_ptr<int>> ptrs{4};
+            ptrs.push(item);
+            ptrs.push(item);
+            REQUIRE(item.use_count() == 3);
+        }
+
+        REQUIRE(item.use_count() == 1);
+    }
+
+    SECTION("pop waits for an item")
+    {
+        thread producer{[&q] {
+            this_thread::sleep_for(10ms);
+            q.push("item");
+        }};
+
+        REQUIRE(q.pop() == "item");
+        producer.join();
+    }
+
+    SECTION("push waits for room")
+    {
+        for (int i = 0; i < 4; ++i)
+            q.push(to_string(i));
+
+        thread consumer{[&q] {
+            this_thread::sleep_for(10ms);
+            q.pop();
+        }};
+
+        q.push("4");
+        consumer.join();
+
+        REQUIRE(q.try_pop() == "1");
+    }
+
+    SECTION("close wakes up blocked consumers and producers")
+    {
+        MpmcRingQueue<int> full{2};
+        full.push(1);
+        full.push(2);
+
+        atomic<int> closed_results{0};
+        vector<thread> threads;
+        threads.emplace_back([&] { closed_results += !q.pop().has_value(); });
+        threads.emplace_back([&] {
+            string item;
+            closed_results += !q.pop(item);
+        });
+        threads.emplace_back([&] {
+            try
+            {
+                full.push(3);
+            }
+            catch (const runtime_error&)
+            {
+                ++closed_results;
+            }
+        });
+
+        this_thread::sleep_for(10ms);
+        q.close();
+        full.close();
+
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(closed_results == 3);
+        REQUIRE_FALSE(q.try_push("item"));
+        REQUIRE_THROWS_AS(q.push("item"), runtime_error);
+    }
+
+    SECTION("items left in a closed queue are drained before it reports closed")
+    {
+        q.push("one");
+        q.close();
+
+        REQUIRE(q.is_closed());
+        REQUIRE(q.pop() == "one");
+        REQUIRE_FALSE(q.pop().has_value());
+    }
+}
+
+TEST_CASE("MpmcRingQueue - move-only items")
+{
+    MpmcRingQueue<unique_ptr<int>> q{2};
+    q.push(make_unique<int>(1));
+    REQUIRE(q.try_emplace(new int{2}));
+
+    unique_ptr<int> item;
+    REQUIRE(q.try_pop(item));
+    REQUIRE(*item == 1);
+    REQUIRE(**q.pop() == 2);
+}
+
+TEST_CASE("MpmcRingQueue - many producers & consumers")
+{
+    const int producer_count = 4;
+    const int consumer_count = 4;
+    const int items_per_producer = 10'000;
+
+    MpmcRingQueue<int> q{64};
+    atomic<long> sum{0};
+    atomic<int> popped{0};
+
+    vector<thread> consumers;
+    for (int i = 0; i < consumer_count; ++i)
+    {
+        consumers.emplace_back([&] {
+            while (auto item = q.pop())
+            {
+                sum += *item;
+                ++popped;
+            }
+        });
+    }
+
+    vector<thread> producers;
+    for (int i = 0; i < producer_count; ++i)
+    {
+        producers.emplace_back([&q] {
+            for (int n = 1; n <= items_per_producer; ++n)
+                q.push(n);
+        });
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    q.close();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    REQUIRE(popped == producer_count * items_per_producer);
+    REQUIRE(sum == producer_count * (items_per_producer * (items_per_producer + 1L) / 2));
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("MpmcRingQueue - close during concurrent pushes")
+{
+    const int producer_count = 4;
+    const int consumer_count = 4;
+
+    MpmcRingQueue<int> q{8};
+    atomic<int> pushed{0};
+    atomic<int> popped{0};
+
+    vector<thread> consumers;
+    for (int i = 0; i < consumer_count; ++i)
+    {
+        consumers.emplace_back([&] {
+            while (q.pop())
+                ++popped;
+        });
+    }
+
+    vector<thread> producers;
+    for (int i = 0; i < producer_count; ++i)
+    {
+        producers.emplace_back([&q, &pushed, i] {
+            try
+            {
+                for (int n = 0;; ++n)
+                {
+                    if (i % 2 == 0)
+                        q.push(n);
+                    else if (!q.try_push(n))
+                    {
+                        if (q.is_closed())
+                            break;
+                        continue;
+                    }
+                    ++pushed;
+                }
+            }
+            catch (const runtime_error&)
+            {
+            }
+        });
+    }
+
+    this_thread::sleep_for(10ms);
+    q.close();
+
+    for (auto& producer : producers)
+        producer.join();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    REQUIRE(pushed > 0);
+    REQUIRE(popped == pushed);
+    REQUIRE(q.empty());
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "future.hpp"
+#include "pooled_allocator.hpp"
+
+using namespace std;
+
+namespace
+{
+    struct Block
+    {
+        char bytes[200];
+    };
+
+    char* block_allocated_at_thread_exit = nullptr;
+
+    // Destroyed after the block cache of its thread (it is constructed before the cache registers)
+    struct AllocatesAtThreadExit
+    {
+        ~AllocatesAtThreadExit()
+        {
+            block_allocated_at_thread_exit = PooledAllocator<char>{}.allocate(65);
+        }
+    };
+
+    thread_local AllocatesAtThreadExit allocates_at_thread_exit;
+} // namespace
+
+TEST_CASE("PooledAllocator")
+{
+    PooledAllocator<Block> allocator;
+
+    SECTION("freed block is reused by the next allocation of its size class")
+    {
+        Block* first = allocator.allocate(1);
+        allocator.deallocate(first, 1);
+
+        Block* second = allocator.allocate(1);
+        REQUIRE(second == first);
+        allocator.deallocate(second, 1);
+    }
+
+    SECTION("blocks of different size classes are not mixed")
+    {
+        PooledAllocator<char> bytes;
+
+        Block* block = allocator.allocate(1);
+        allocator.deallocate(block, 1);
+
+        char* small = bytes.allocate(16);
+        REQUIRE(static_cast<void*>(small) != static_cast<void*>(block));
+        bytes.deallocate(small, 16);
+    }
+
+    SECTION("live blocks are distinct")
+    {
+        vector<Block*> blocks;
+        for (int i = 0; i < 100; ++i)
+            blocks.push_back(allocator.allocate(1));
+
+        REQUIRE(set<Block*>(blocks.begin(), blocks.end()).size() == blocks.size());
+
+        for (auto* block : blocks)
+            allocator.deallocate(block, 1);
+    }
+
+    SECTION("large blocks bypass the freelists")
+    {
+        Block* large = allocator.allocate(100);
+        large[99].bytes[0] = 'x';
+        allocator.deallocate(large, 100);
+    }
+
+    SECTION("block may be freed by another thread")
+    {
+        vector<Block*> blocks;
+        for (int i = 0; i < 1'000; ++i)
+            blocks.push_back(allocator.allocate(1));
+
+        thread consumer{[&] {
+            for (auto* block : blocks)
+                allocator.deallocate(block, 1);
+        }};
+        consumer.join();
+    }
+
+    SECTION("block allocated during thread exit fits its size class")
+    {
+        thread exiting{[] {
+            [[maybe_unused]] auto* construct_first = &allocates_at_thread_exit;
+            PooledAllocator<Block>{}.deallocate(PooledAllocator<Block>{}.allocate(1), 1); // registers the cache
+        }};
+        exiting.join();
+
+        PooledAllocator<char> bytes;
+        bytes.deallocate(block_allocated_at_thread_exit, 65);
+
+        char* reused = bytes.allocate(128);
+        REQUIRE(reused == block_allocated_at_thread_exit);
+        fill(reused, reused + 128, 'x');
+        bytes.deallocate(reused, 128);
+    }
+
+    SECTION("allocate_shared recycles the control block together with the object")
+    {
+        const int* first = nullptr;
+        {
+            auto value = allocate_shared<int>(PooledAllocator<int>{}, 1);
+            first = value.get();
+        }
+
+        auto value = allocate_shared<int>(PooledAllocator<int>{}, 2);
+        REQUIRE(value.get() == first);
+    }
+
+    SECTION("futures with pooled shared state")
+    {
+        for (int i = 0; i < 1'000; ++i)
+        {
+            Promise<int> p;
+            auto f = p.get_future();
+            p.set_value(i);
+            REQUIRE(f.get() == i);
+        }
+    }
+}
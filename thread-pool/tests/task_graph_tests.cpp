@@ -0,0 +1,171 @@
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "task_graph.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+TEST_CASE("TaskGraph")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+    ThreadPool pool{4, scheduling};
+
+    SECTION("empty graph is ready at once")
+    {
+        TaskGraph graph;
+        auto f = graph.run(pool);
+        REQUIRE(f.is_ready());
+        REQUIRE_NOTHROW(f.get());
+    }
+
+    SECTION("read - process - merge")
+    {
+        vector<int> data;
+        vector<long> partial_sums(4);
+        long total = 0;
+
+        TaskGraph graph;
+        auto read = graph.add_node([&data] {
+            data.resize(100);
+            iota(data.begin(), data.end(), 1);
+        });
+        auto merge = graph.add_node([&] { total = accumulate(partial_sums.begin(), partial_sums.end(), 0L); });
+
+        for (int id = 0; id < 4; ++id)
+        {
+            auto process = graph.add_node([&, id] {
+                partial_sums[id] = accumulate(data.begin() + id * 25, data.begin() + (id + 1) * 25, 0L);
+            });
+            graph.add_edge(read, process);
+            graph.add_edge(process, merge);
+        }
+
+        REQUIRE(graph.node_count() == 6);
+
+        graph.run(pool).get();
+        REQUIRE(total == 5050);
+    }
+
+    SECTION("a node starts only after all its inputs have finished")
+    {
+        mutex mtx;
+        vector<int> order;
+        auto record = [&](int id) {
+            return [&, id] {
+                lock_guard lk{mtx};
+                order.push_back(id);
+            };
+        };
+
+        // diamond: 0 -> {1, 2} -> 3 -> 4
+        TaskGraph graph;
+        for (int id = 0; id < 5; ++id)
+            graph.add_node(record(id));
+        graph.add_edge(0, 1);
+        graph.add_edge(0, 2);
+        graph.add_edge(1, 3);
+        graph.add_edge(2, 3);
+        graph.add_edge(3, 4);
+
+        graph.run(pool).get();
+
+        REQUIRE(order.size() == 5);
+        REQUIRE(order.front() == 0);
+        REQUIRE(order[3] == 3);
+        REQUIRE(order.back() == 4);
+    }
+
+    SECTION("graph is reusable across runs")
+    {
+        atomic<int> counter{0};
+
+        TaskGraph graph;
+        auto root = graph.add_node([&counter] { ++counter; });
+        for (int i = 0; i < 10; ++i)
+        {
+            auto node = graph.add_node([&counter] { ++counter; });
+            graph.add_edge(root, node);
+        }
+
+        for (int run = 1; run <= 50; ++run)
+        {
+            graph.run(pool).get();
+            REQUIRE(counter == run * 11);
+        }
+    }
+
+    SECTION("nodes may be added between runs")
+    {
+        atomic<int> counter{0};
+
+        TaskGraph graph;
+        auto first = graph.add_node([&counter] { ++counter; });
+        graph.run(pool).get();
+
+        auto second = graph.add_node([&counter] { counter += 10; });
+        graph.add_edge(first, second);
+        graph.run(pool).get();
+
+        REQUIRE(counter == 12);
+    }
+
+    SECTION("exception skips the remaining nodes and is stored in the future")
+    {
+        atomic<int> executed{0};
+
+        TaskGraph graph;
+        auto failing = graph.add_node([] { throw runtime_error{"Error#1"}; });
+        auto skipped = graph.add_node([&executed] { ++executed; });
+        graph.add_edge(failing, skipped);
+
+        REQUIRE_THROWS_WITH(graph.run(pool).get(), "Error#1");
+        REQUIRE(executed == 0);
+        REQUIRE_FALSE(graph.is_running());
+    }
+
+    SECTION("cycle is rejected")
+    {
+        TaskGraph graph;
+        auto a = graph.add_node([] { });
+        auto b = graph.add_node([] { });
+        graph.add_edge(a, b);
+        graph.add_edge(b, a);
+
+        REQUIRE_THROWS_AS(graph.run(pool), logic_error);
+        REQUIRE_FALSE(graph.is_running());
+    }
+
+    SECTION("graph cannot be modified or started while running")
+    {
+        promise<void> gate;
+        auto gate_future = gate.get_future().share();
+
+        TaskGraph graph;
+        graph.add_node([gate_future] { gate_future.wait(); });
+
+        auto f = graph.run(pool);
+        REQUIRE_THROWS_AS(graph.add_node([] { }), logic_error);
+        REQUIRE_THROWS_AS(graph.run(pool), logic_error);
+
+        gate.set_value();
+        f.get();
+    }
+
+    SECTION("nodes dropped by a shut down pool break the promise")
+    {
+        TaskGraph graph;
+        graph.add_node([] { });
+
+        pool.shutdown();
+        REQUIRE_THROWS_AS(graph.run(pool).get(), future_error);
+        REQUIRE_FALSE(graph.is_running());
+    }
+}
@@ -0,0 +1,77 @@
+#include <array>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "catch.hpp"
+
+#include "task.hpp"
+
+using namespace std;
+
+TEST_CASE("Task")
+{
+    SECTION("is empty after default construction")
+    {
+        Task task;
+
+        REQUIRE_FALSE(task);
+        REQUIRE_THROWS_AS(task(), std::bad_function_call);
+    }
+
+    SECTION("invokes stored callable")
+    {
+        int counter = 0;
+        Task task{[&counter] { ++counter; }};
+
+        task();
+        task();
+
+        REQUIRE(counter == 2);
+    }
+
+    SECTION("accepts move-only callables")
+    {
+        std::packaged_task<int()> pt{[] { return 42; }};
+        auto f = pt.get_future();
+
+        Task task{std::move(pt)};
+        task();
+
+        REQUIRE(f.get() == 42);
+    }
+
+    SECTION("small callables are stored inline")
+    {
+        auto small = [ptr = std::unique_ptr<int>{}, text = std::string{}] {};
+        auto large = [data = std::array<char, 256>{}] {};
+
+        REQUIRE(Task::fits_inline<decltype(small)>);
+        REQUIRE(Task::fits_inline<std::packaged_task<int()>>);
+        REQUIRE_FALSE(Task::fits_inline<decltype(large)>);
+    }
+
+    SECTION("move transfers ownership of inline and heap callables")
+    {
+        auto value = std::make_shared<int>(0);
+        std::array<char, 256> padding{};
+
+        Task small{[value] { ++*value; }};
+        Task large{[value, padding] { ++*value; }};
+
+        Task moved_small = std::move(small);
+        Task moved_large;
+        moved_large = std::move(large);
+
+        REQUIRE_FALSE(small);
+        REQUIRE_FALSE(large);
+
+        moved_small();
+        moved_large();
+        REQUIRE(*value == 2);
+
+        moved_small = nullptr;
+        moved_large = nullptr;
+        REQUIRE(value.use_count() == 1);
+    }
+}
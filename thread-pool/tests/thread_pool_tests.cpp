@@ -0,0 +1,1265 @@
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "thread_pool.hpp"
+
+using namespace std;
+
+TEST_CASE("ThreadPool")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{4, scheduling};
+
+    SECTION("submit returns future with result")
+    {
+        auto f = pool.submit([] { return 42; });
+
+        REQUIRE(f.get() == 42);
+    }
+
+    SECTION("exception is passed through future")
+    {
+        auto f = pool.submit([]() -> int { throw std::runtime_error("Error#3"); });
+
+        REQUIRE_THROWS_AS(f.get(), std::runtime_error);
+    }
+
+    SECTION("all submitted tasks are executed")
+    {
+        atomic<int> counter{0};
+
+        vector<Future<void>> fs;
+        for (int i = 0; i < 1000; ++i)
+            fs.push_back(pool.submit([&counter] { ++counter; }));
+
+        for (auto& f : fs)
+            f.get();
+
+        REQUIRE(counter == 1000);
+    }
+
+    SECTION("tasks submitted from a worker are executed")
+    {
+        auto f = pool.submit([&pool] {
+            vector<Future<int>> nested;
+            for (int i = 0; i < 100; ++i)
+                nested.push_back(pool.submit([i] { return i; }));
+            return nested;
+        });
+
+        auto nested = f.get();
+        int sum = 0;
+        for (auto& nf : nested)
+            sum += nf.get();
+
+        REQUIRE(sum == 4950);
+    }
+
+    SECTION("tasks queued at destruction are drained")
+    {
+        atomic<int> counter{0};
+
+        {
+            ThreadPool local_pool{2, scheduling};
+            for (int i = 0; i < 100; ++i)
+                local_pool.submit([&counter] { this_thread::sleep_for(100us); ++counter; });
+        }
+
+        REQUIRE(counter == 100);
+    }
+}
+
+TEST_CASE("ThreadPool - work stealing")
+{
+    ThreadPool pool{4, ThreadPool::Scheduling::work_stealing};
+
+    SECTION("idle workers steal tasks from a busy worker's deque")
+    {
+        mutex mtx;
+        set<thread::id> thread_ids;
+
+        auto f = pool.submit([&] {
+            vector<Future<void>> nested;
+            for (int i = 0; i < 64; ++i)
+            {
+                nested.push_back(pool.submit([&] {
+                    this_thread::sleep_for(1ms);
+                    lock_guard lk{mtx};
+                    thread_ids.insert(this_thread::get_id());
+                }));
+            }
+            for (auto& nf : nested)
+                nf.wait();
+        });
+
+        f.get();
+
+        REQUIRE(thread_ids.size() > 1);
+    }
+}
+
+TEST_CASE("ThreadPool - submit_bulk")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{4, scheduling};
+
+    SECTION("returns futures in the order of the range")
+    {
+        auto futures = pool.submit_bulk(views::iota(0, 100) | views::transform([](int i) { return [i] { return i * i; }; }));
+
+        REQUIRE(futures.size() == 100);
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(futures[i].get() == i * i);
+    }
+
+    SECTION("copies callables from an lvalue container")
+    {
+        auto shared = make_shared<int>(1);
+        vector<function<int()>> callables(10, [shared] { return *shared; });
+
+        auto futures = pool.submit_bulk(callables);
+
+        int sum = 0;
+        for (auto& f : futures)
+            sum += f.get();
+
+        REQUIRE(sum == 10);
+        REQUIRE(callables.front() != nullptr);
+    }
+
+    SECTION("bulk submitted from a worker is executed")
+    {
+        auto f = pool.submit([&pool] {
+            return pool.submit_bulk(views::iota(0, 100) | views::transform([](int i) { return [i] { return i; }; }));
+        });
+
+        int sum = 0;
+        for (auto& nf : f.get())
+            sum += nf.get();
+
+        REQUIRE(sum == 4950);
+    }
+
+    SECTION("empty range")
+    {
+        auto futures = pool.submit_bulk(vector<function<void()>>{});
+
+        REQUIRE(futures.empty());
+    }
+}
+
+TEST_CASE("ThreadPool - parallel_for & parallel_reduce")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{4, scheduling};
+
+    SECTION("parallel_for visits every index exactly once")
+    {
+        vector<atomic<int>> visits(10'000);
+
+        pool.parallel_for(0, 10'000, [&visits](int i) { ++visits[i]; });
+
+        REQUIRE(all_of(visits.begin(), visits.end(), [](const auto& v) { return v == 1; }));
+    }
+
+    SECTION("parallel_for spreads unbalanced work across threads")
+    {
+        mutex mtx;
+        set<thread::id> thread_ids;
+
+        pool.parallel_for(0, 64, [&](int i) {
+            if (i < 32)
+                this_thread::sleep_for(1ms);
+            lock_guard lk{mtx};
+            thread_ids.insert(this_thread::get_id());
+        }, 1);
+
+        REQUIRE(thread_ids.size() > 1);
+    }
+
+    SECTION("parallel_for rethrows exception from body")
+    {
+        REQUIRE_THROWS_AS(pool.parallel_for(0, 1000, [](int i) { if (i == 500) throw std::runtime_error("Error#500"); }), std::runtime_error);
+    }
+
+    SECTION("parallel_for on empty range")
+    {
+        bool called = false;
+        pool.parallel_for(10, 10, [&](int) { called = true; });
+
+        REQUIRE_FALSE(called);
+    }
+
+    SECTION("parallel_reduce sums a range")
+    {
+        auto sum = pool.parallel_reduce(
+            0L, 100'000L, 0L,
+            [](long first, long last, long acc) {
+                for (long i = first; i < last; ++i)
+                    acc += i;
+                return acc;
+            },
+            std::plus{});
+
+        REQUIRE(sum == 4'999'950'000L);
+    }
+
+    SECTION("parallel_reduce combines partial results in index order")
+    {
+        auto text = pool.parallel_reduce(
+            0, 26, string{},
+            [](int first, int last, string acc) {
+                for (int i = first; i < last; ++i)
+                    acc += static_cast<char>('a' + i);
+                return acc;
+            },
+            std::plus{}, 1);
+
+        REQUIRE(text == "abcdefghijklmnopqrstuvwxyz");
+    }
+
+    SECTION("narrow index types")
+    {
+        atomic<int> visits{0};
+        pool.parallel_for(int16_t{-300}, int16_t{300}, [&visits](int16_t) { ++visits; });
+        pool.parallel_for(uint8_t{0}, uint8_t{255}, [&visits](uint8_t) { ++visits; });
+
+        REQUIRE(visits == 600 + 255);
+    }
+
+    SECTION("caller outside the pool runs only pieces of its own range")
+    {
+        ThreadPool single{1, scheduling};
+        Future<thread::id> background;
+
+        single.parallel_for(0, 16, [&](int i) {
+            if (i == 0)
+                background = single.submit(ThreadPool::Priority::low, [] { return this_thread::get_id(); });
+            this_thread::sleep_for(1ms);
+        }, 1);
+
+        REQUIRE(background.get() != this_thread::get_id());
+    }
+
+    SECTION("nested parallel_for inside a task")
+    {
+        atomic<int> counter{0};
+
+        auto f = pool.submit([&] {
+            pool.parallel_for(0, 100, [&](int) {
+                pool.parallel_for(0, 100, [&](int) { ++counter; });
+            });
+        });
+        f.get();
+
+        REQUIRE(counter == 10'000);
+    }
+}
+
+namespace
+{
+    long fibonacci(ThreadPool& pool, int n)
+    {
+        if (n < 2)
+            return n;
+
+        auto f_left = pool.submit([&pool, n] { return fibonacci(pool, n - 1); });
+        long right = fibonacci(pool, n - 2);
+
+        return f_left.get() + right;
+    }
+} // namespace
+
+TEST_CASE("ThreadPool - helping wait")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    SECTION("recursive fork/join on a small pool does not deadlock")
+    {
+        ThreadPool pool{2, scheduling};
+
+        auto f = pool.submit([&pool] { return fibonacci(pool, 16); });
+
+        REQUIRE(f.get() == 987);
+    }
+
+    SECTION("worker blocked on a future of its own pool runs queued tasks")
+    {
+        ThreadPool pool{1, scheduling};
+
+        auto f = pool.submit([&pool] {
+            auto nested = pool.submit([] { return this_thread::get_id(); });
+            return nested.get() == this_thread::get_id();
+        });
+
+        REQUIRE(f.get() == true);
+    }
+
+    SECTION("wait helps while waiting for std::future")
+    {
+        ThreadPool pool{1, scheduling};
+
+        auto f = pool.submit([&pool] {
+            std::promise<int> p;
+            auto result = p.get_future();
+            pool.submit([&p] { p.set_value(42); });
+            pool.wait(result);
+            return result.get();
+        });
+
+        REQUIRE(f.get() == 42);
+    }
+}
+
+TEST_CASE("ThreadPool - continuations")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{2, scheduling};
+
+    SECTION("continuations run on the pool")
+    {
+        auto f = pool.submit([] { return 6; })
+                     .then([](int x) { return x * 7; })
+                     .then([](int x) { return pair{x, this_thread::get_id()}; });
+
+        auto [result, thread_id] = f.get();
+
+        REQUIRE(result == 42);
+        REQUIRE(thread_id != this_thread::get_id());
+    }
+
+    SECTION("exception from a task is passed down the chain")
+    {
+        auto f = pool.submit([]() -> int { throw std::runtime_error("Error#3"); })
+                     .then([](int x) { return x * x; })
+                     .then([](int x) { return to_string(x); });
+
+        REQUIRE_THROWS_AS(f.get(), std::runtime_error);
+    }
+
+    SECTION("long pipeline does not block workers")
+    {
+        Future<int> f = pool.submit([] { return 0; });
+        for (int i = 0; i < 1000; ++i)
+            f = f.then([](int x) { return x + 1; });
+
+        REQUIRE(f.get() == 1000);
+    }
+
+    SECTION("continuations of a future that outlives its pool run inline")
+    {
+        Promise<int> promise;
+        Future<pair<int, thread::id>> attached_before;
+        Future<int> orphan;
+        {
+            ThreadPool short_lived{1, scheduling};
+            promise = Promise<int>{&short_lived};
+            attached_before = promise.get_future().then([](int x) { return pair{x + 1, this_thread::get_id()}; });
+            orphan = short_lived.submit([] { return 6; });
+        }
+
+        promise.set_value(1);
+        auto [result, thread_id] = attached_before.get();
+        REQUIRE(result == 2);
+        REQUIRE(thread_id == this_thread::get_id());
+
+        auto attached_after = orphan.then([](int x) { return pair{x * 7, this_thread::get_id()}; });
+        REQUIRE(attached_after.is_ready());
+        REQUIRE(attached_after.get() == pair{42, this_thread::get_id()});
+    }
+
+    SECTION("continuation of a task dropped by abort is broken")
+    {
+        std::promise<void> gate;
+        auto opened = gate.get_future().share();
+        std::latch started{2};
+        for (int i = 0; i < 2; ++i)
+            pool.submit([opened, &started] { started.count_down(); opened.wait(); });
+        started.wait();
+
+        auto f = pool.submit([] { return 1; }).then([](int x) { return x + 1; });
+
+        thread releaser{[&gate] { this_thread::sleep_for(10ms); gate.set_value(); }};
+        pool.shutdown(ThreadPool::ShutdownMode::abort);
+        releaser.join();
+
+        REQUIRE_THROWS_AS(f.get(), future_error);
+    }
+}
+
+TEST_CASE("ThreadPool - priority lanes")
+{
+    using enum ThreadPool::Priority;
+
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    mutex mtx;
+    vector<string> order;
+    auto record = [&](string name) {
+        return [&, name] { lock_guard lk{mtx}; order.push_back(name); };
+    };
+
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    std::promise<void> started;
+
+    ThreadPool pool{1, scheduling};
+
+    auto blocker = pool.submit([&started, opened] { started.set_value(); opened.wait(); });
+    started.get_future().wait();
+
+    SECTION("higher priority lanes are served first")
+    {
+        pool.submit(low, record("low"));
+        pool.submit(normal, record("normal"));
+        pool.submit(high, record("high"));
+
+        REQUIRE(pool.queue_depth(high) == 1);
+        REQUIRE(pool.queue_depth(normal) == 1);
+        REQUIRE(pool.queue_depth(low) == 1);
+
+        gate.set_value();
+        pool.submit(low, [] {}).get();
+
+        REQUIRE(order == vector<string>{"high", "normal", "low"});
+        REQUIRE(pool.queue_depth(low) == 0);
+    }
+
+    SECTION("low priority lane is not starved by a burst of high priority tasks")
+    {
+        vector<Future<void>> fs;
+        fs.push_back(pool.submit(low, record("low")));
+        for (int i = 0; i < 100; ++i)
+            fs.push_back(pool.submit(high, record("high")));
+
+        gate.set_value();
+        for (auto& f : fs)
+            f.get(); // a sentinel task could overtake the remaining high priority tasks
+
+        auto low_position = find(order.begin(), order.end(), "low") - order.begin();
+        REQUIRE(low_position < 20);
+    }
+
+    SECTION("low priority lane is not starved by a worker feeding itself")
+    {
+        const int steps = 20'000;
+        atomic<int> done_steps{0};
+        int steps_before_low = -1;
+        std::promise<void> chain_done;
+        function<void()> step = [&] {
+            if (++done_steps < steps)
+                pool.post(step); // a worker's normal priority task - in work_stealing mode it stays local
+            else
+                chain_done.set_value();
+        };
+
+        auto low_task = pool.submit(low, [&] { steps_before_low = done_steps.load(); });
+        pool.post(step);
+
+        gate.set_value();
+        chain_done.get_future().wait();
+        low_task.get();
+
+        REQUIRE(steps_before_low < 20);
+    }
+
+    SECTION("high priority task submitted by a worker overtakes its local backlog")
+    {
+        gate.set_value();
+
+        auto f = pool.submit([&] {
+            for (int i = 0; i < 10; ++i)
+                pool.submit(record("normal"));
+            pool.submit(high, record("high"));
+        });
+        f.get();
+        pool.submit(low, [] {}).get();
+
+        REQUIRE(order.front() == "high");
+    }
+
+    if (opened.wait_for(0s) != future_status::ready)
+        gate.set_value();
+    blocker.get();
+}
+
+TEST_CASE("ThreadPool - cancellation")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{1, scheduling};
+
+    auto is_broken_promise = Catch::Predicate<future_error>([](const future_error& e) { return e.code() == future_errc::broken_promise; });
+
+    std::promise<void> gate;
+    auto blocker = [opened = gate.get_future().share()] { opened.wait(); };
+
+    SECTION("callable taking a stop_token returns a cancellable future")
+    {
+        static_assert(std::is_same_v<decltype(pool.submit([] { return 1; })), Future<int>>);
+        static_assert(std::is_same_v<decltype(pool.submit([](stop_token) { return 1; })), CancellableFuture<int>>);
+
+        gate.set_value();
+    }
+
+    SECTION("running task observes the stop request")
+    {
+        std::latch started{1};
+        auto f = pool.submit([&started](stop_token token) {
+            started.count_down();
+            int iterations = 0;
+            while (!token.stop_requested())
+            {
+                ++iterations;
+                this_thread::sleep_for(100us);
+            }
+            return iterations;
+        });
+
+        started.wait();
+        REQUIRE(f.request_stop());
+        REQUIRE(f.stop_requested());
+        REQUIRE(f.get() >= 0);
+
+        gate.set_value();
+    }
+
+    SECTION("cancelled task that has not started never runs")
+    {
+        pool.submit(blocker);
+
+        atomic<bool> has_run{false};
+        auto f = pool.submit([&has_run](stop_token) { has_run = true; });
+        f.request_stop();
+
+        gate.set_value();
+
+        REQUIRE_THROWS_MATCHES(f.get(), future_error, is_broken_promise);
+        REQUIRE_FALSE(has_run);
+    }
+
+    SECTION("one stop_source cancels a whole batch")
+    {
+        pool.submit(blocker);
+
+        std::stop_source batch;
+        atomic<int> executed{0};
+        vector<Future<void>> fs;
+        for (int i = 0; i < 10'000; ++i)
+            fs.push_back(pool.submit(batch.get_token(), [&executed] { ++executed; }));
+
+        batch.request_stop();
+        gate.set_value();
+
+        for (auto& f : fs)
+            REQUIRE_THROWS_MATCHES(f.get(), future_error, is_broken_promise);
+        REQUIRE(executed == 0);
+        REQUIRE(pool.submit([] { return 42; }).get() == 42);
+    }
+
+    SECTION("task runs when stop is never requested")
+    {
+        gate.set_value();
+
+        std::stop_source source;
+        auto f = pool.submit(ThreadPool::Priority::high, source.get_token(), [](stop_token token) { return token.stop_possible(); });
+
+        REQUIRE(f.get() == true);
+    }
+}
+
+TEST_CASE("ThreadPool - post")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    mutex mtx;
+    vector<string> errors;
+    ThreadPool::Options options{.min_threads = 2, .max_threads = 2, .scheduling = scheduling,
+        .exception_handler = [&](exception_ptr eptr) {
+            try
+            {
+                rethrow_exception(eptr);
+            }
+            catch (const exception& e)
+            {
+                lock_guard lk{mtx};
+                errors.push_back(e.what());
+            }
+        }};
+
+    SECTION("runs posted callables")
+    {
+        atomic<int> executed{0};
+        {
+            ThreadPool pool{options};
+            for (int i = 0; i < 1'000; ++i)
+                pool.post([&executed] { ++executed; });
+            pool.post(ThreadPool::Priority::high, [&executed] { ++executed; });
+        }
+
+        REQUIRE(executed == 1'001);
+    }
+
+    SECTION("result of a posted callable is discarded")
+    {
+        atomic<int> executed{0};
+        {
+            ThreadPool pool{options};
+            pool.post([&executed] { return ++executed; });
+        }
+
+        REQUIRE(executed == 1);
+    }
+
+    SECTION("uncaught exceptions go to the handler")
+    {
+        {
+            ThreadPool pool{options};
+            for (int i = 0; i < 3; ++i)
+                pool.post([i] { throw runtime_error{"Error#" + to_string(i)}; });
+        }
+
+        std::ranges::sort(errors);
+        REQUIRE(errors == vector<string>{"Error#0", "Error#1", "Error#2"});
+    }
+
+    SECTION("worker survives an exception")
+    {
+        ThreadPool pool{options};
+        pool.post([] { throw runtime_error{"Error"}; });
+
+        REQUIRE(pool.submit([] { return 42; }).get() == 42);
+    }
+
+    SECTION("post after shutdown throws")
+    {
+        ThreadPool pool{options};
+        pool.shutdown();
+
+        REQUIRE_THROWS_AS(pool.post([] { }), std::runtime_error);
+    }
+}
+
+namespace
+{
+    struct WorkerScratch
+    {
+        explicit WorkerScratch(atomic<int>& destroyed)
+            : destroyed{&destroyed}
+        {
+        }
+
+        WorkerScratch(const WorkerScratch&) = delete;
+        WorkerScratch& operator=(const WorkerScratch&) = delete;
+
+        ~WorkerScratch()
+        {
+            ++*destroyed;
+        }
+
+        atomic<int>* destroyed;
+        vector<int> buffer;
+    };
+} // namespace
+
+TEST_CASE("ThreadPool - worker hooks & worker-local state")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    mutex mtx;
+    multiset<size_t> started;
+    multiset<size_t> stopped;
+    set<thread::id> initialized_threads;
+    ThreadPool::Options options{.min_threads = 2, .max_threads = 2, .scheduling = scheduling,
+        .on_worker_start = [&](size_t index) {
+            lock_guard lk{mtx};
+            started.insert(index);
+            initialized_threads.insert(this_thread::get_id());
+        },
+        .on_worker_stop = [&](size_t index) {
+            lock_guard lk{mtx};
+            stopped.insert(index);
+        }};
+
+    SECTION("hooks run once per worker")
+    {
+        {
+            ThreadPool pool{options};
+            for (int i = 0; i < 100; ++i)
+                pool.post([] { });
+        }
+
+        REQUIRE(started == multiset<size_t>{0, 1});
+        REQUIRE(stopped == multiset<size_t>{0, 1});
+    }
+
+    SECTION("start hook runs before the worker takes a task")
+    {
+        atomic<int> uninitialized{0};
+        {
+            ThreadPool pool{options};
+            for (int i = 0; i < 100; ++i)
+            {
+                pool.post([&] {
+                    lock_guard lk{mtx};
+                    if (!initialized_threads.contains(this_thread::get_id()))
+                        ++uninitialized;
+                });
+            }
+        }
+
+        REQUIRE(uninitialized == 0);
+    }
+
+    SECTION("worker-local state is built once per worker and destroyed when it exits")
+    {
+        atomic<int> constructed{0};
+        atomic<int> destroyed{0};
+        set<WorkerScratch*> instances;
+        auto make_scratch = [&] {
+            ++constructed;
+            return WorkerScratch{destroyed};
+        };
+
+        {
+            ThreadPool pool{options};
+            for (int i = 0; i < 1'000; ++i)
+            {
+                pool.post([&, i] {
+                    auto& scratch = worker_local<WorkerScratch>(make_scratch);
+                    scratch.buffer.push_back(i);
+
+                    lock_guard lk{mtx};
+                    instances.insert(&scratch);
+                });
+            }
+        }
+
+        REQUIRE(constructed == static_cast<int>(instances.size()));
+        REQUIRE(constructed <= 2);
+        REQUIRE(destroyed == constructed);
+    }
+
+    SECTION("instances are told apart by the factory")
+    {
+        ThreadPool pool{options};
+        auto [first, second] = pool.submit([] {
+            return pair{&worker_local<int>([] { return 1; }), &worker_local<int>([] { return 2; })};
+        }).get();
+
+        REQUIRE(first != second);
+    }
+
+    SECTION("the value category of the factory does not change the instance")
+    {
+        ThreadPool pool{options};
+        auto same = pool.submit([] {
+            auto make = [] { return 1; };
+            const auto& const_make = make;
+            int* from_lvalue = &worker_local<int>(make);
+            return from_lvalue == &worker_local<int>(const_make) && from_lvalue == &worker_local<int>(std::move(make));
+        }).get();
+
+        REQUIRE(same);
+    }
+
+    SECTION("exception escaping a hook goes to the exception handler")
+    {
+        atomic<int> errors{0};
+        options.on_worker_start = [](size_t) { throw runtime_error{"Error"}; };
+        options.exception_handler = [&errors](exception_ptr) { ++errors; };
+
+        {
+            ThreadPool pool{options};
+            REQUIRE(pool.submit([] { return 42; }).get() == 42);
+        }
+
+        REQUIRE(errors == 2);
+    }
+}
+
+TEST_CASE("ThreadPool - bounded queue")
+{
+    using OverflowPolicy = ThreadPool::OverflowPolicy;
+
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    auto bounded_pool = [scheduling](OverflowPolicy policy) {
+        return make_unique<ThreadPool>(ThreadPool::Options{.min_threads = 1, .max_threads = 1, .scheduling = scheduling,
+            .queue_capacity = 4, .overflow_policy = policy});
+    };
+
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+
+    // blocks the only worker and leaves the shared queue with capacity tasks
+    auto fill = [&opened](ThreadPool& pool) {
+        std::latch started{1};
+        pool.submit([&started, opened] { started.count_down(); opened.wait(); });
+        started.wait();
+
+        vector<Future<int>> fs;
+        for (int i = 0; i < 4; ++i)
+            fs.push_back(pool.submit([i] { return i; }));
+        return fs;
+    };
+
+    SECTION("unbounded by default")
+    {
+        ThreadPool pool{1, scheduling};
+        REQUIRE(pool.queue_capacity() == 0);
+        gate.set_value();
+    }
+
+    SECTION("try_submit fails when the queue is full")
+    {
+        auto pool = bounded_pool(OverflowPolicy::block);
+        auto queued = fill(*pool);
+
+        REQUIRE_FALSE(pool->try_submit([] { return 5; }).has_value());
+        REQUIRE(pool->queue_high_water_mark() == 4);
+
+        gate.set_value();
+        for (auto& f : queued)
+            f.get();
+
+        auto f = pool->try_submit([] { return 5; });
+        REQUIRE(f.has_value());
+        REQUIRE(f->get() == 5);
+    }
+
+    SECTION("block waits until a worker takes a task")
+    {
+        auto pool = bounded_pool(OverflowPolicy::block);
+        auto queued = fill(*pool);
+
+        atomic<bool> is_submitted{false};
+        thread producer{[&] {
+            pool->submit([] { return 5; }).get();
+            is_submitted = true;
+        }};
+
+        this_thread::sleep_for(20ms);
+        REQUIRE_FALSE(is_submitted);
+
+        gate.set_value();
+        producer.join();
+
+        REQUIRE(is_submitted);
+        REQUIRE(pool->queue_high_water_mark() == 4);
+    }
+
+    SECTION("reject throws")
+    {
+        auto pool = bounded_pool(OverflowPolicy::reject);
+        auto queued = fill(*pool);
+
+        REQUIRE_THROWS_AS(pool->submit([] { }), std::runtime_error);
+
+        gate.set_value();
+    }
+
+    SECTION("caller_runs runs the task on the submitting thread")
+    {
+        auto pool = bounded_pool(OverflowPolicy::caller_runs);
+        auto queued = fill(*pool);
+
+        auto f = pool->submit([] { return this_thread::get_id(); });
+        REQUIRE(f.is_ready());
+        REQUIRE(f.get() == this_thread::get_id());
+
+        gate.set_value();
+    }
+
+    SECTION("drop_oldest drops the oldest task of the lowest lane")
+    {
+        auto pool = bounded_pool(OverflowPolicy::drop_oldest);
+        auto queued = fill(*pool);
+
+        auto f = pool->submit([] { return 5; });
+
+        REQUIRE_THROWS_MATCHES(queued[0].get(), future_error,
+            Catch::Predicate<future_error>([](const future_error& e) { return e.code() == future_errc::broken_promise; }));
+
+        gate.set_value();
+        REQUIRE(queued[1].get() == 1);
+        REQUIRE(f.get() == 5);
+        REQUIRE(pool->queue_high_water_mark() == 4);
+    }
+
+    SECTION("submit_bulk applies the policy to every task")
+    {
+        auto pool = bounded_pool(OverflowPolicy::caller_runs);
+        auto queued = fill(*pool);
+
+        vector<std::function<thread::id()>> callables(3, [] { return this_thread::get_id(); });
+        auto fs = pool->submit_bulk(callables);
+
+        for (auto& f : fs)
+            REQUIRE(f.get() == this_thread::get_id());
+
+        gate.set_value();
+    }
+
+    SECTION("workers are not limited")
+    {
+        auto pool = bounded_pool(OverflowPolicy::reject);
+        gate.set_value();
+
+        auto f = pool->submit([&pool] {
+            vector<Future<int>> nested;
+            for (int i = 0; i < 100; ++i)
+                nested.push_back(pool->submit([i] { return i; }));
+
+            int sum = 0;
+            for (auto& n : nested)
+                sum += n.get();
+            return sum;
+        });
+
+        REQUIRE(f.get() == 4950);
+    }
+
+    SECTION("memory stays bounded under overload")
+    {
+        auto pool = bounded_pool(OverflowPolicy::block);
+        gate.set_value();
+
+        atomic<int> executed{0};
+        for (int i = 0; i < 10'000; ++i)
+            pool->submit([&executed] { ++executed; });
+        pool->shutdown();
+
+        REQUIRE(executed == 10'000);
+        REQUIRE(pool->queue_high_water_mark() <= 4);
+    }
+
+    SECTION("shutdown wakes blocked submitters")
+    {
+        auto pool = bounded_pool(OverflowPolicy::block);
+        auto queued = fill(*pool);
+
+        std::promise<void> failed;
+        thread producer{[&] {
+            try
+            {
+                pool->submit([] { });
+            }
+            catch (const std::runtime_error&)
+            {
+                failed.set_value();
+            }
+        }};
+
+        this_thread::sleep_for(10ms);
+        thread releaser{[&gate] { this_thread::sleep_for(10ms); gate.set_value(); }};
+        pool->shutdown();
+        releaser.join();
+        producer.join();
+
+        REQUIRE(failed.get_future().wait_for(0s) == std::future_status::ready);
+    }
+}
+
+TEST_CASE("ThreadPool - shutdown")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    atomic<int> executed{0};
+    ThreadPool pool{2, scheduling};
+
+    SECTION("drain runs all queued tasks")
+    {
+        for (int i = 0; i < 100; ++i)
+            pool.submit([&executed] { this_thread::sleep_for(100us); ++executed; });
+
+        pool.shutdown(ThreadPool::ShutdownMode::drain);
+
+        REQUIRE(executed == 100);
+        REQUIRE(pool.is_shut_down());
+    }
+
+    SECTION("drain runs tasks submitted by running tasks")
+    {
+        pool.submit([&] {
+            this_thread::sleep_for(10ms);
+            pool.submit([&executed] { ++executed; });
+        });
+
+        pool.shutdown();
+
+        REQUIRE(executed == 1);
+    }
+
+    SECTION("abort drops queued tasks and breaks their futures")
+    {
+        std::promise<void> gate;
+        auto opened = gate.get_future().share();
+        std::latch started{2};
+        for (int i = 0; i < 2; ++i)
+            pool.submit([opened, &started] { started.count_down(); opened.wait(); });
+        started.wait(); // both workers are blocked
+
+        vector<Future<void>> dropped;
+        for (int i = 0; i < 1'000; ++i)
+            dropped.push_back(pool.submit([&executed] { ++executed; }));
+
+        thread releaser{[&gate] { this_thread::sleep_for(10ms); gate.set_value(); }};
+        pool.shutdown(ThreadPool::ShutdownMode::abort);
+        releaser.join();
+
+        REQUIRE(executed == 0);
+        REQUIRE_THROWS_MATCHES(dropped.back().get(), future_error,
+            Catch::Predicate<future_error>([](const future_error& e) { return e.code() == future_errc::broken_promise; }));
+    }
+
+    SECTION("submit after shutdown throws")
+    {
+        pool.shutdown();
+
+        REQUIRE_THROWS_AS(pool.submit([] {}), std::runtime_error);
+    }
+
+    SECTION("shutdown from a worker throws")
+    {
+        auto f = pool.submit([&pool] { pool.shutdown(); });
+
+        REQUIRE_THROWS_AS(f.get(), std::logic_error);
+    }
+
+    SECTION("futures outlive the pool")
+    {
+        Future<int> done;
+        Promise<int> promise;
+        Future<int> pending;
+        {
+            ThreadPool short_lived{1, scheduling};
+            done = short_lived.submit([] { return 1; });
+            promise = Promise<int>{&short_lived};
+            pending = promise.get_future();
+        }
+
+        REQUIRE(done.get() == 1);
+        REQUIRE(pending.executor() == nullptr);
+
+        thread setter{[&promise] { this_thread::sleep_for(10ms); promise.set_value(2); }};
+        pending.wait();
+        REQUIRE(pending.get() == 2);
+        setter.join();
+    }
+}
+
+TEST_CASE("ThreadPool - delayed and periodic tasks")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{1, scheduling};
+
+    SECTION("submit_after runs the task once the delay has passed")
+    {
+        const auto start = chrono::steady_clock::now();
+        auto f = pool.submit_after(20ms, [start] { return chrono::steady_clock::now() - start; });
+
+        REQUIRE(f.get() >= 20ms);
+    }
+
+    SECTION("delay does not occupy a worker")
+    {
+        auto delayed = pool.submit_after(1h, [] { return 1; });
+
+        REQUIRE(pool.submit([] { return 2; }).get() == 2);
+        REQUIRE_FALSE(delayed.is_ready());
+        REQUIRE(pool.timer_count() == 1);
+    }
+
+    SECTION("submit_at accepts time points of other clocks")
+    {
+        auto f = pool.submit_at(chrono::system_clock::now() + 10ms, [] { return 42; });
+
+        REQUIRE(f.get() == 42);
+    }
+
+    SECTION("tasks run in the order of their due times")
+    {
+        mutex mtx;
+        vector<int> order;
+        vector<Future<void>> fs;
+        for (int i : {3, 1, 2})
+            fs.push_back(pool.submit_after(i * 10ms, [&, i] { lock_guard lk{mtx}; order.push_back(i); }));
+
+        for (auto& f : fs)
+            f.get();
+
+        REQUIRE(order == vector{1, 2, 3});
+    }
+
+    SECTION("thousands of pending timers share one timer thread")
+    {
+        atomic<int> executed{0};
+        vector<Future<void>> fs;
+        for (int i = 0; i < 5'000; ++i)
+            fs.push_back(pool.submit_after(chrono::microseconds{i % 20'000}, [&executed] { ++executed; }));
+
+        for (auto& f : fs)
+            f.get();
+
+        REQUIRE(executed == 5'000);
+        REQUIRE(pool.size() == 1);
+    }
+
+    SECTION("submit_every runs the task until it is cancelled")
+    {
+        atomic<int> runs{0};
+        auto handle = pool.submit_every(1ms, [&runs] { ++runs; });
+
+        while (runs < 5)
+            this_thread::sleep_for(1ms);
+
+        handle.cancel();
+        REQUIRE(handle.is_cancelled());
+        REQUIRE_NOTHROW(handle.stopped().get());
+
+        const int runs_after_cancel = runs;
+        this_thread::sleep_for(10ms);
+        REQUIRE(runs == runs_after_cancel);
+    }
+
+    SECTION("cancel stops a periodic task with a long period at once")
+    {
+        auto handle = pool.submit_every(1h, [] { });
+
+        handle.cancel();
+
+        REQUIRE(handle.stopped().is_ready());
+        REQUIRE(pool.timer_count() == 0);
+    }
+
+    SECTION("exception stops a periodic task")
+    {
+        atomic<int> runs{0};
+        auto handle = pool.submit_every(1ms, [&runs] {
+            if (++runs == 3)
+                throw runtime_error{"Error#3"};
+        });
+
+        REQUIRE_THROWS_WITH(handle.stopped().get(), "Error#3");
+        REQUIRE(runs == 3);
+    }
+
+    SECTION("shutdown drops pending delayed tasks and stops periodic tasks")
+    {
+        auto delayed = pool.submit_after(1h, [] { });
+        auto handle = pool.submit_every(1h, [] { });
+
+        pool.shutdown();
+
+        REQUIRE_THROWS_MATCHES(delayed.get(), future_error,
+            Catch::Predicate<future_error>([](const future_error& e) { return e.code() == future_errc::broken_promise; }));
+        REQUIRE_NOTHROW(handle.stopped().get());
+        REQUIRE_THROWS_AS(pool.submit_after(1ms, [] { }), std::runtime_error);
+    }
+
+    SECTION("cancel is a no-op after the pool is destroyed")
+    {
+        auto short_lived = make_unique<ThreadPool>(1, scheduling);
+        auto handle = short_lived->submit_every(1h, [] { });
+        short_lived.reset();
+
+        handle.cancel();
+
+        REQUIRE(handle.stopped().is_ready());
+        REQUIRE_NOTHROW(handle.stopped().get());
+    }
+
+    SECTION("period must be positive")
+    {
+        REQUIRE_THROWS_AS(pool.submit_every(0ms, [] { }), std::invalid_argument);
+    }
+}
+
+TEST_CASE("ThreadPool - elastic sizing")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool::Options options{.min_threads = 1, .max_threads = 4, .scheduling = scheduling, .idle_timeout = 50ms, .stall_timeout = 5ms};
+
+    SECTION("fixed size pool is not elastic")
+    {
+        ThreadPool pool{2, scheduling};
+
+        REQUIRE_FALSE(pool.is_elastic());
+        REQUIRE(pool.min_threads() == 2);
+        REQUIRE(pool.max_threads() == 2);
+    }
+
+    SECTION("grows when queued tasks wait behind blocked workers")
+    {
+        ThreadPool pool{options};
+        REQUIRE(pool.size() == 1);
+
+        std::latch all_running{4};
+        vector<Future<void>> fs;
+        for (int i = 0; i < 4; ++i)
+            fs.push_back(pool.submit([&all_running] { all_running.arrive_and_wait(); })); // completes only when 4 threads run it
+
+        for (auto& f : fs)
+            f.get();
+
+        REQUIRE(pool.size() == 4);
+    }
+
+    SECTION("does not grow beyond max_threads")
+    {
+        ThreadPool pool{options};
+
+        vector<Future<void>> fs;
+        for (int i = 0; i < 16; ++i)
+            fs.push_back(pool.submit([] { this_thread::sleep_for(10ms); }));
+
+        for (auto& f : fs)
+            f.get();
+
+        REQUIRE(pool.size() <= 4);
+    }
+
+    SECTION("idle threads above min_threads retire")
+    {
+        ThreadPool pool{options};
+
+        std::latch all_running{3};
+        vector<Future<void>> fs;
+        for (int i = 0; i < 3; ++i)
+            fs.push_back(pool.submit([&all_running] { all_running.arrive_and_wait(); }));
+        for (auto& f : fs)
+            f.get();
+        REQUIRE(pool.size() >= 3);
+
+        const auto deadline = chrono::steady_clock::now() + 5s;
+        while (pool.size() > 1 && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(10ms);
+
+        REQUIRE(pool.size() == 1);
+        REQUIRE(pool.submit([] { return 42; }).get() == 42);
+    }
+}
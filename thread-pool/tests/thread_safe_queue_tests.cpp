@@ -0,0 +1,258 @@
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "thread_safe_queue.hpp"
+
+using namespace std;
+
+namespace
+{
+    struct CopyCounter
+    {
+        static inline int copies = 0;
+
+        explicit CopyCounter(string payload)
+            : payload{std::move(payload)}
+        {
+        }
+
+        CopyCounter(const CopyCounter& other)
+            : payload{other.payload}
+        {
+            ++copies;
+        }
+
+        CopyCounter& operator=(const CopyCounter& other)
+        {
+            payload = other.payload;
+            ++copies;
+            return *this;
+        }
+
+        CopyCounter(CopyCounter&&) = default;
+        CopyCounter& operator=(CopyCounter&&) = default;
+
+        string payload;
+    };
+} // namespace
+
+TEST_CASE("ThreadSafeQueue - moving items")
+{
+    CopyCounter::copies = 0;
+    ThreadSafeQueue<CopyCounter> q;
+
+    SECTION("emplace constructs the item in place")
+    {
+        q.emplace("payload");
+
+        auto item = q.try_pop();
+        REQUIRE(item);
+        REQUIRE(item->payload == "payload");
+        REQUIRE(CopyCounter::copies == 0);
+    }
+
+    SECTION("pops move the item out of the queue")
+    {
+        q.push(CopyCounter{"first"});
+        q.push(CopyCounter{"second"});
+        q.emplace("third");
+        q.emplace("fourth");
+
+        CopyCounter item{""};
+        REQUIRE(q.try_pop(item));
+        REQUIRE(item.payload == "first");
+
+        q.pop(item);
+        REQUIRE(item.payload == "second");
+
+        REQUIRE(q.pop()->payload == "third");
+        REQUIRE(q.try_pop()->payload == "fourth");
+
+        REQUIRE(CopyCounter::copies == 0);
+    }
+
+    SECTION("try_pop returns an empty optional when the queue is empty")
+    {
+        REQUIRE_FALSE(q.try_pop().has_value());
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - move-only items")
+{
+    ThreadSafeQueue<unique_ptr<int>> q;
+
+    SECTION("push & try_pop")
+    {
+        q.push(make_unique<int>(1));
+        q.emplace(new int{2});
+
+        unique_ptr<int> item;
+        REQUIRE(q.try_pop(item));
+        REQUIRE(*item == 1);
+        REQUIRE(**q.try_pop() == 2);
+    }
+
+    SECTION("pop waits for an item")
+    {
+        thread producer{[&q] { q.push(make_unique<int>(42)); }};
+
+        auto item = q.pop();
+        producer.join();
+
+        REQUIRE(**item == 42);
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - batches")
+{
+    ThreadSafeQueue<int> q;
+
+    SECTION("push_range pushes all items in order")
+    {
+        const vector<int> items{1, 2, 3, 4};
+        q.push_range(items.begin(), items.end());
+
+        vector<int> popped;
+        REQUIRE(q.pop_all(back_inserter(popped)) == 4);
+        REQUIRE(popped == items);
+        REQUIRE(q.empty());
+    }
+
+    SECTION("pop_up_to takes at most n items")
+    {
+        q.push({1, 2, 3, 4, 5});
+
+        vector<int> popped;
+        REQUIRE(q.pop_up_to(3, back_inserter(popped)) == 3);
+        REQUIRE(popped == vector{1, 2, 3});
+
+        REQUIRE(q.pop_up_to(3, back_inserter(popped)) == 2);
+        REQUIRE(popped == vector{1, 2, 3, 4, 5});
+    }
+
+    SECTION("pop_all waits for an item")
+    {
+        thread producer{[&q] { q.push(42); }};
+
+        vector<int> popped;
+        REQUIRE(q.pop_all(back_inserter(popped)) == 1);
+        producer.join();
+
+        REQUIRE(popped == vector{42});
+    }
+
+    SECTION("push_range wakes a waiting consumer per item")
+    {
+        const int consumer_count = 3;
+        vector<vector<int>> popped(consumer_count);
+        vector<thread> consumers;
+        for (int i = 0; i < consumer_count; ++i)
+            consumers.emplace_back([&q, &popped, i] { q.pop_up_to(1, back_inserter(popped[i])); });
+
+        const vector<int> items{1, 2, 3};
+        q.push_range(items.begin(), items.end());
+
+        for (auto& consumer : consumers)
+            consumer.join();
+
+        for (const auto& batch : popped)
+            REQUIRE(batch.size() == 1);
+    }
+
+    SECTION("batches of move-only items")
+    {
+        ThreadSafeQueue<unique_ptr<int>> ptrs;
+        ptrs.emplace(new int{1});
+        ptrs.emplace(new int{2});
+
+        vector<unique_ptr<int>> popped;
+        REQUIRE(ptrs.pop_all(back_inserter(popped)) == 2);
+        REQUIRE(*popped[1] == 2);
+
+        ptrs.push_range(make_move_iterator(popped.begin()), make_move_iterator(popped.end()));
+        REQUIRE_FALSE(popped[0]);
+        REQUIRE(**ptrs.try_pop() == 1);
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - timed waits & close")
+{
+    ThreadSafeQueue<int> q;
+
+    SECTION("pop_for times out on an empty queue")
+    {
+        const auto start = chrono::steady_clock::now();
+        REQUIRE_FALSE(q.pop_for(20ms).has_value());
+        REQUIRE(chrono::steady_clock::now() - start >= 20ms);
+        REQUIRE_FALSE(q.is_closed());
+    }
+
+    SECTION("pop_until returns an item pushed before the deadline")
+    {
+        thread producer{[&q] {
+            this_thread::sleep_for(10ms);
+            q.push(42);
+        }};
+
+        auto item = q.pop_until(chrono::steady_clock::now() + 10s);
+        producer.join();
+
+        REQUIRE(item == 42);
+    }
+
+    SECTION("close wakes up all waiting consumers")
+    {
+        atomic<int> closed_results{0};
+        vector<thread> consumers;
+        consumers.emplace_back([&] { closed_results += !q.pop().has_value(); });
+        consumers.emplace_back([&] {
+            int item;
+            closed_results += !q.pop(item);
+        });
+        consumers.emplace_back([&] { closed_results += !q.pop_for(1h).has_value(); });
+        consumers.emplace_back([&] {
+            vector<int> items;
+            closed_results += q.pop_all(back_inserter(items)) == 0;
+        });
+
+        this_thread::sleep_for(10ms);
+        q.close();
+
+        for (auto& consumer : consumers)
+            consumer.join();
+
+        REQUIRE(closed_results == 4);
+    }
+
+    SECTION("items left in a closed queue are drained before it reports closed")
+    {
+        q.push({1, 2});
+        q.close();
+
+        REQUIRE(q.is_closed());
+        REQUIRE(q.pop() == 1);
+        REQUIRE(q.pop_for(1h) == 2);
+        REQUIRE_FALSE(q.pop().has_value());
+        REQUIRE_FALSE(q.try_pop().has_value());
+    }
+
+    SECTION("push to a closed queue throws")
+    {
+        q.close();
+
+        const vector<int> items{1};
+        REQUIRE_THROWS_AS(q.push(1), runtime_error);
+        REQUIRE_THROWS_AS(q.emplace(1), runtime_error);
+        REQUIRE_THROWS_AS(q.push_range(items.begin(), items.end()), runtime_error);
+        REQUIRE(q.empty());
+    }
+}
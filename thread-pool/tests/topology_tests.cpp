@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <latch>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "numa_thread_pool.hpp"
+#include "topology.hpp"
+
+using namespace std;
+
+TEST_CASE("parse_cpu_list")
+{
+    SECTION("single cpus and ranges")
+    {
+        REQUIRE(parse_cpu_list("0-3,8,10-11\n") == vector{0, 1, 2, 3, 8, 10, 11});
+    }
+
+    SECTION("empty list")
+    {
+        REQUIRE(parse_cpu_list("").empty());
+    }
+
+    SECTION("malformed list throws")
+    {
+        REQUIRE_THROWS_AS(parse_cpu_list("0-x"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_list("3-1"), std::invalid_argument);
+    }
+}
+
+TEST_CASE("numa_topology")
+{
+    SECTION("every node has cpus the process may use")
+    {
+        auto nodes = numa_topology();
+        auto allowed = available_cpus();
+
+        REQUIRE_FALSE(nodes.empty());
+        for (const auto& node : nodes)
+        {
+            REQUIRE_FALSE(node.cpus.empty());
+            REQUIRE(all_of(node.cpus.begin(), node.cpus.end(), [&](int cpu) { return find(allowed.begin(), allowed.end(), cpu) != allowed.end(); }));
+        }
+    }
+
+    SECTION("missing sysfs gives a single node with all cpus")
+    {
+        auto nodes = numa_topology("/nonexistent/node");
+
+        REQUIRE(nodes.size() == 1);
+        REQUIRE(nodes[0].cpus == available_cpus());
+    }
+
+    SECTION("nodes are read from sysfs layout")
+    {
+        const auto root = filesystem::temp_directory_path() / "thread_pool_topology_test";
+        filesystem::remove_all(root);
+        filesystem::create_directories(root / "node1");
+        filesystem::create_directories(root / "node0");
+        filesystem::create_directories(root / "power");
+        const int cpu = available_cpus().front();
+        ofstream{root / "node0" / "cpulist"} << cpu << "\n";
+        ofstream{root / "node1" / "cpulist"} << "\n"; // memory-only node
+
+        auto nodes = numa_topology(root);
+        filesystem::remove_all(root);
+
+        REQUIRE(nodes.size() == 1);
+        REQUIRE(nodes[0].id == 0);
+        REQUIRE(nodes[0].cpus == vector{cpu});
+    }
+}
+
+TEST_CASE("ThreadPool - cpu affinity")
+{
+    const int cpu = available_cpus().front();
+
+    SECTION("workers run on the given cpus")
+    {
+        ThreadPool pool{ThreadPool::Options{.min_threads = 2, .max_threads = 2, .cpus = {cpu}}};
+
+        std::latch both_running{2};
+        vector<Future<int>> cpus;
+        for (int i = 0; i < 2; ++i)
+            cpus.push_back(pool.submit([&both_running] { both_running.arrive_and_wait(); return current_cpu(); }));
+
+        for (auto& f : cpus)
+            REQUIRE(f.get() == cpu);
+        REQUIRE(pool.worker_cpus() == vector{cpu, cpu});
+    }
+
+    SECTION("unavailable cpu is rejected")
+    {
+        REQUIRE_THROWS_AS((ThreadPool{ThreadPool::Options{.min_threads = 1, .cpus = {1 << 20}}}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("NumaThreadPool")
+{
+    NumaThreadPool pool;
+
+    SECTION("one pool per node sized to its cpus")
+    {
+        REQUIRE(pool.node_count() == numa_topology().size());
+        for (size_t i = 0; i < pool.node_count(); ++i)
+            REQUIRE(pool.pool(i).size() == pool.node(i).cpus.size());
+    }
+
+    SECTION("task with a node hint runs on a cpu of that node")
+    {
+        for (size_t i = 0; i < pool.node_count(); ++i)
+        {
+            auto cpu = pool.submit(i, [] { return current_cpu(); }).get();
+            const auto& cpus = pool.node(i).cpus;
+
+            REQUIRE(find(cpus.begin(), cpus.end(), cpu) != cpus.end());
+        }
+    }
+
+    SECTION("task without a hint runs on the caller's node")
+    {
+        REQUIRE(pool.submit([] { return 42; }).get() == 42);
+    }
+
+    SECTION("empty list of nodes is rejected")
+    {
+        REQUIRE_THROWS_AS(NumaThreadPool(ThreadPool::Scheduling::shared_queue, vector<NumaNode>{}), invalid_argument);
+    }
+}
@@ -0,0 +1,146 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "two_lock_queue.hpp"
+
+using namespace std;
+
+TEST_CASE("TwoLockQueue")
+{
+    TwoLockQueue<string> q;
+
+    SECTION("is empty after creation")
+    {
+        REQUIRE(q.empty());
+        REQUIRE_FALSE(q.try_pop().has_value());
+    }
+
+    SECTION("pops items in FIFO order")
+    {
+        q.push("one");
+        q.push(string{"two"});
+        q.emplace(3, 'x');
+
+        string item;
+        REQUIRE(q.try_pop(item));
+        REQUIRE(item == "one");
+        REQUIRE(q.pop() == "two");
+        REQUIRE(q.pop(item));
+        REQUIRE(item == "xxx");
+        REQUIRE(q.empty());
+    }
+
+    SECTION("nodes are reused after the queue was emptied")
+    {
+        for (int round = 0; round < 100; ++round)
+        {
+            for (int i = 0; i < 10; ++i)
+                q.push(to_string(i));
+
+            for (int i = 0; i < 10; ++i)
+                REQUIRE(q.pop() == to_string(i));
+        }
+
+        REQUIRE(q.empty());
+    }
+
+    SECTION("pop waits for an item")
+    {
+        thread producer{[&q] {
+            this_thread::sleep_for(10ms);
+            q.push("item");
+        }};
+
+        REQUIRE(q.pop() == "item");
+        producer.join();
+    }
+
+    SECTION("close wakes up all waiting consumers")
+    {
+        atomic<int> closed_results{0};
+        vector<thread> consumers;
+        for (int i = 0; i < 3; ++i)
+            consumers.emplace_back([&] { closed_results += !q.pop().has_value(); });
+
+        this_thread::sleep_for(10ms);
+        q.close();
+
+        for (auto& consumer : consumers)
+            consumer.join();
+
+        REQUIRE(closed_results == 3);
+        REQUIRE_THROWS_AS(q.push("item"), runtime_error);
+    }
+
+    SECTION("items left in a closed queue are drained before it reports closed")
+    {
+        q.push("one");
+        q.close();
+
+        REQUIRE(q.is_closed());
+        REQUIRE(q.pop() == "one");
+        REQUIRE_FALSE(q.pop().has_value());
+    }
+}
+
+TEST_CASE("TwoLockQueue - move-only items")
+{
+    TwoLockQueue<unique_ptr<int>> q;
+    q.push(make_unique<int>(1));
+    q.emplace(new int{2});
+
+    unique_ptr<int> item;
+    REQUIRE(q.try_pop(item));
+    REQUIRE(*item == 1);
+    REQUIRE(**q.pop() == 2);
+}
+
+TEST_CASE("TwoLockQueue - many producers & consumers")
+{
+    const int producer_count = 4;
+    const int consumer_count = 4;
+    const int items_per_producer = 10'000;
+
+    TwoLockQueue<int> q;
+    atomic<long> sum{0};
+    atomic<int> popped{0};
+
+    vector<thread> consumers;
+    for (int i = 0; i < consumer_count; ++i)
+    {
+        consumers.emplace_back([&] {
+            while (auto item = q.pop())
+            {
+                sum += *item;
+                ++popped;
+            }
+        });
+    }
+
+    vector<thread> producers;
+    for (int i = 0; i < producer_count; ++i)
+    {
+        producers.emplace_back([&q] {
+            for (int n = 1; n <= items_per_producer; ++n)
+                q.push(n);
+        });
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    q.close();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    REQUIRE(popped == producer_count * items_per_producer);
+    REQUIRE(sum == producer_count * (items_per_producer * (items_per_producer + 1L) / 2));
+    REQUIRE(q.empty());
+}
@@ -0,0 +1,244 @@
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "thread_pool.hpp"
+#include "when.hpp"
+
+using namespace std;
+
+TEST_CASE("when_all")
+{
+    SECTION("ready when all futures are ready")
+    {
+        Promise<int> p1;
+        Promise<string> p2;
+
+        auto all = when_all(p1.get_future(), p2.get_future());
+
+        p1.set_value(1);
+        REQUIRE_FALSE(all.is_ready());
+
+        p2.set_value("two");
+        REQUIRE(all.is_ready());
+
+        auto [f1, f2] = all.get();
+        REQUIRE(f1.get() == 1);
+        REQUIRE(f2.get() == "two");
+    }
+
+    SECTION("exceptions stay in the futures")
+    {
+        Promise<int> p1;
+        Promise<void> p2;
+
+        auto all = when_all(p1.get_future(), p2.get_future());
+        p2.set_value();
+        p1.set_exception(make_exception_ptr(runtime_error{"Error#3"}));
+
+        auto [f1, f2] = all.get();
+        REQUIRE_THROWS_AS(f1.get(), runtime_error);
+        REQUIRE_NOTHROW(f2.get());
+    }
+
+    SECTION("no futures")
+    {
+        REQUIRE(when_all().is_ready());
+    }
+
+    SECTION("vector of futures")
+    {
+        vector<Promise<int>> promises(10);
+        vector<Future<int>> futures;
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+
+        auto all = when_all(std::move(futures));
+        for (int i = 9; i >= 0; --i)
+            promises[i].set_value(i);
+
+        int sum = 0;
+        for (auto& f : all.get())
+            sum += f.get();
+        REQUIRE(sum == 45);
+    }
+
+    SECTION("empty vector")
+    {
+        REQUIRE(when_all(vector<Future<int>>{}).get().empty());
+    }
+}
+
+TEST_CASE("when_any")
+{
+    SECTION("ready when the first future is ready")
+    {
+        vector<Promise<int>> promises(3);
+        vector<Future<int>> futures;
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+
+        auto any = when_any(std::move(futures));
+        REQUIRE_FALSE(any.is_ready());
+
+        promises[2].set_value(42);
+        promises[0].set_value(0);
+
+        auto [index, fs] = any.get();
+        REQUIRE(index == 2);
+        REQUIRE(fs.size() == 3);
+        REQUIRE(fs[2].get() == 42);
+        REQUIRE(fs[1].valid());
+        REQUIRE_FALSE(fs[1].is_ready());
+    }
+
+    SECTION("future ready before the call wins")
+    {
+        vector<Promise<int>> promises(3);
+        vector<Future<int>> futures;
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+        promises[1].set_value(1);
+
+        auto result = when_any(std::move(futures)).get();
+
+        REQUIRE(result.index == 1);
+    }
+
+    SECTION("empty vector")
+    {
+        auto result = when_any(vector<Future<int>>{}).get();
+
+        REQUIRE(result.index == WhenAnyResult<int>::no_index);
+        REQUIRE(result.futures.empty());
+    }
+}
+
+TEST_CASE("as_completed")
+{
+    SECTION("futures are visited in completion order")
+    {
+        vector<Promise<int>> promises(3);
+        vector<Future<int>> futures;
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+
+        thread producer{[&] {
+            for (int i : {2, 0, 1})
+            {
+                this_thread::sleep_for(1ms);
+                promises[i].set_value(i * 10);
+            }
+        }};
+
+        vector<size_t> order;
+        for (auto [index, f] : as_completed(std::move(futures)))
+        {
+            order.push_back(index);
+            REQUIRE(f.get() == static_cast<int>(index) * 10);
+        }
+        producer.join();
+
+        REQUIRE(order == vector<size_t>{2, 0, 1});
+    }
+
+    SECTION("empty sequence")
+    {
+        int visited = 0;
+        for ([[maybe_unused]] auto item : as_completed(vector<Future<int>>{}))
+            ++visited;
+
+        REQUIRE(visited == 0);
+    }
+}
+
+TEST_CASE("ThreadPool - combinators")
+{
+    auto scheduling = GENERATE(ThreadPool::Scheduling::shared_queue, ThreadPool::Scheduling::work_stealing);
+
+    ThreadPool pool{2, scheduling};
+
+    SECTION("continuation of when_all runs on the pool")
+    {
+        auto sum = when_all(pool.submit([] { return 1; }), pool.submit([] { return 2; }))
+                       .then([](tuple<Future<int>, Future<int>> fs) { return get<0>(fs).get() + get<1>(fs).get(); });
+
+        REQUIRE(sum.get() == 3);
+    }
+
+    SECTION("slow task does not hold up results that are done")
+    {
+        std::promise<void> gate;
+        auto opened = gate.get_future().share();
+
+        vector<Future<int>> futures;
+        futures.push_back(pool.submit([opened] { opened.wait(); return 0; }));
+        futures.push_back(pool.submit([] { return 1; }));
+
+        auto any = when_any(std::move(futures)).get();
+        REQUIRE(any.index == 1);
+
+        gate.set_value();
+        REQUIRE(any.futures[0].get() == 0);
+    }
+
+    SECTION("as_completed inside a worker helps the pool")
+    {
+        ThreadPool single{1, scheduling};
+
+        auto f = single.submit([&single] {
+            vector<Future<int>> futures;
+            for (int i = 0; i < 10; ++i)
+                futures.push_back(single.submit([i] { return i; }));
+
+            int sum = 0;
+            for (auto [index, nf] : as_completed(std::move(futures)))
+                sum += nf.get();
+            return sum;
+        });
+
+        REQUIRE(f.get() == 45);
+    }
+
+    SECTION("combinators of futures that outlive their pool")
+    {
+        vector<Promise<int>> promises(4);
+        auto [all, sequence] = [&] {
+            ThreadPool short_lived{1, scheduling};
+            vector<Future<int>> futures;
+            for (auto& promise : promises)
+            {
+                promise = Promise<int>{&short_lived};
+                futures.push_back(promise.get_future());
+            }
+
+            vector<Future<int>> first_half;
+            first_half.push_back(std::move(futures[0]));
+            first_half.push_back(std::move(futures[1]));
+            vector<Future<int>> second_half;
+            second_half.push_back(std::move(futures[2]));
+            second_half.push_back(std::move(futures[3]));
+
+            return pair{when_all(std::move(first_half)), as_completed(std::move(second_half))};
+        }();
+
+        thread setter{[&promises] {
+            this_thread::sleep_for(10ms);
+            for (int i = 0; i < 4; ++i)
+                promises[i].set_value(i);
+        }};
+
+        int sum = 0;
+        for (auto [index, f] : sequence)
+            sum += f.get();
+        REQUIRE(sum == 2 + 3);
+        REQUIRE(all.get().size() == 2);
+
+        setter.join();
+    }
+}
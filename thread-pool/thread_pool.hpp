@@ -0,0 +1,1442 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "coroutine.hpp"
+#include "future.hpp"
+#include "metrics.hpp"
+#include "task.hpp"
+#include "timer_queue.hpp"
+#include "topology.hpp"
+#include "worker_local.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// std::hardware_destructive_interference_size is not ABI-stable (gcc warns when it is used in a header)
+inline constexpr std::size_t cache_line_size = 64;
+
+namespace detail
+{
+    // Callable that observes cancellation through a std::stop_token argument
+    template <typename Callable>
+    concept takes_stop_token = std::invocable<std::decay_t<Callable>&, std::stop_token>;
+
+    template <typename F>
+    struct StoppableResult : std::invoke_result<F&>
+    {
+    };
+
+    template <typename F>
+        requires takes_stop_token<F>
+    struct StoppableResult<F> : std::invoke_result<F&, std::stop_token>
+    {
+    };
+} // namespace detail
+
+class ThreadPool : public Executor
+{
+public:
+    enum class Scheduling
+    {
+        shared_queue, // all workers pop from one queue
+        work_stealing // every worker owns a deque; idle workers steal from the others
+    };
+
+    enum class Priority
+    {
+        high,
+        normal,
+        low
+    };
+
+    static constexpr size_t priority_count = 3;
+
+    // What submit() does when the shared queue of a bounded pool is full
+    enum class OverflowPolicy
+    {
+        block,       // waits until a worker takes a task
+        reject,      // throws std::runtime_error (try_submit() returns an empty optional with any policy)
+        caller_runs, // runs the task on the submitting thread - slows the producer down to the pool's pace
+        drop_oldest  // drops the oldest task of the lowest non-empty lane - its future fails with broken_promise
+    };
+
+    enum class ShutdownMode
+    {
+        drain, // queued tasks are run before the workers exit
+        abort  // queued tasks are dropped - their futures fail with std::future_errc::broken_promise
+    };
+
+    struct Options
+    {
+        unsigned int min_threads = std::thread::hardware_concurrency();
+        unsigned int max_threads = 0; // above min_threads the pool is elastic
+        Scheduling scheduling = Scheduling::shared_queue;
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds{10}; // idle extra threads of an elastic pool retire after
+        std::chrono::milliseconds stall_timeout{50};                       // elastic pool grows when no queued task was started for so long
+        std::vector<int> cpus;        // workers run only on these CPUs (e.g. one NUMA node); empty - no pinning
+        bool pin_each_worker = false; // worker i runs only on cpus[i % cpus.size()] instead of the whole set
+        size_t queue_capacity = 0;    // limit of the shared queue for submissions from outside the pool; 0 - unbounded
+        OverflowPolicy overflow_policy = OverflowPolicy::block;
+        std::function<void(std::exception_ptr)> exception_handler; // exceptions escaping posted tasks and worker hooks; empty - reported on std::cerr
+        std::function<void(size_t)> on_worker_start; // run by every worker thread with its index before it takes any task
+        std::function<void(size_t)> on_worker_stop;  // run by every worker thread with its index when it exits (shutdown or retirement)
+    };
+
+    ThreadPool(const unsigned int size = std::thread::hardware_concurrency(), Scheduling scheduling = Scheduling::shared_queue)
+        : ThreadPool{Options{.min_threads = size, .max_threads = size, .scheduling = scheduling}}
+    {
+    }
+
+    explicit ThreadPool(const Options& options)
+        : m_min_threads{std::max(options.min_threads, 1u)}
+        , m_max_threads{std::max(options.max_threads, m_min_threads)}
+        , m_scheduling{options.scheduling}
+        , m_idle_timeout{options.idle_timeout}
+        , m_stall_timeout{options.stall_timeout}
+        , m_cpus{options.cpus}
+        , m_pin_each_worker{options.pin_each_worker}
+        , m_queue_capacity{options.queue_capacity}
+        , m_overflow_policy{options.overflow_policy}
+        , m_exception_handler{options.exception_handler ? options.exception_handler : report_uncaught_exception}
+        , m_on_worker_start{options.on_worker_start}
+        , m_on_worker_stop{options.on_worker_stop}
+        , m_pool(m_max_threads)
+    {
+        const auto allowed = available_cpus();
+        for (int cpu : m_cpus)
+        {
+            if (std::ranges::find(allowed, cpu) == allowed.end())
+                throw std::invalid_argument{"ThreadPool: cpu " + std::to_string(cpu) + " is not available"};
+        }
+
+        m_workers.reserve(m_max_threads);
+        for (unsigned int i = 0; i < m_max_threads; ++i)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+
+        std::lock_guard lk{m_mtx};
+        for (unsigned int i = 0; i < m_min_threads; ++i)
+        {
+            m_workers[i]->is_active = true;
+            m_pool[i] = std::thread([this, i] { Run_(i); });
+        }
+        m_thread_count = m_min_threads;
+
+        if (is_elastic())
+            m_supervisor = std::thread([this] { Supervise_(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename Callable>
+    auto submit(Callable&& callable)
+    {
+        return submit(Priority::normal, std::forward<Callable>(callable));
+    }
+
+    // Tasks of a higher priority lane are dequeued first; a lower lane that was passed over
+    // starvation_limit times in a row is served next, so low priority work still makes progress.
+    // A callable taking a std::stop_token gets a CancellableFuture - see submit(stop_token, callable).
+    template <typename Callable>
+    auto submit(Priority priority, Callable&& callable)
+    {
+        if constexpr (detail::takes_stop_token<Callable>)
+        {
+            std::stop_source source;
+            auto f = submit(priority, source.get_token(), std::forward<Callable>(callable));
+            return CancellableFuture<typename detail::StoppableResult<std::decay_t<Callable>>::type>{std::move(f), std::move(source)};
+        }
+        else
+        {
+            auto [task, f] = make_task(std::forward<Callable>(callable));
+
+            submit_task(std::move(task), priority);
+
+            return f;
+        }
+    }
+
+    // Fire-and-forget: the callable is queued as it is - no promise, no shared state, no result.
+    // An exception escaping it is passed to Options::exception_handler on the thread that ran it.
+    template <typename Callable>
+        requires std::invocable<std::decay_t<Callable>&>
+    void post(Callable&& callable)
+    {
+        post(Priority::normal, std::forward<Callable>(callable));
+    }
+
+    template <typename Callable>
+        requires std::invocable<std::decay_t<Callable>&>
+    void post(Priority priority, Callable&& callable)
+    {
+        submit_task(Task{std::forward<Callable>(callable)}, priority);
+    }
+
+    // Never blocks, runs on the caller or drops another task: an empty optional when the shared queue of
+    // a bounded pool is full (whatever the overflow policy)
+    template <typename Callable>
+    auto try_submit(Callable&& callable)
+    {
+        return try_submit(Priority::normal, std::forward<Callable>(callable));
+    }
+
+    template <typename Callable>
+    auto try_submit(Priority priority, Callable&& callable)
+    {
+        auto [task, f] = make_task(std::forward<Callable>(callable));
+
+        std::optional<decltype(f)> result;
+        if (try_submit_task(task, priority))
+            result = std::move(f);
+
+        return result;
+    }
+
+    // Cancellable submission: once stop is requested on the token a task that has not started is skipped
+    // when dequeued - the callable never runs and the future holds std::future_error (broken_promise).
+    // A callable taking a std::stop_token gets this token, so a running task may stop early.
+    // One token shared by a whole batch cancels all of it with a single request_stop().
+    template <typename Callable>
+    auto submit(std::stop_token token, Callable&& callable)
+    {
+        return submit(Priority::normal, std::move(token), std::forward<Callable>(callable));
+    }
+
+    template <typename Callable>
+    auto submit(Priority priority, std::stop_token token, Callable&& callable)
+    {
+        auto [task, f] = make_stoppable_task(std::move(token), std::forward<Callable>(callable));
+
+        submit_task(std::move(task), priority);
+
+        return f;
+    }
+
+    // Runs callable on a worker once the delay has passed - the delay is spent in the timer queue, not on a worker
+    template <typename Rep, typename Period, typename Callable>
+    auto submit_after(std::chrono::duration<Rep, Period> delay, Callable&& callable)
+    {
+        return submit_at(TimerQueue::Clock::now() + std::chrono::ceil<TimerQueue::Clock::duration>(delay), std::forward<Callable>(callable));
+    }
+
+    // Time points of other clocks (e.g. system_clock) are converted to the steady clock when submitted
+    template <typename Clock, typename Duration, typename Callable>
+    auto submit_at(std::chrono::time_point<Clock, Duration> time, Callable&& callable)
+    {
+        throw_if_closed_for_timers();
+
+        auto [task, f] = make_task(std::forward<Callable>(callable));
+        m_timers->schedule(to_timer_clock(time), std::move(task));
+
+        return f;
+    }
+
+    // Runs callable every period (the first run is one period from now) until the handle is cancelled,
+    // a run throws or the pool shuts down. Runs do not overlap; due times missed by a slow run are skipped.
+    template <typename Rep, typename Period, typename Callable>
+    PeriodicHandle submit_every(std::chrono::duration<Rep, Period> period, Callable&& callable)
+    {
+        using Run = detail::PeriodicRun<std::decay_t<Callable>>;
+
+        const auto timer_period = std::chrono::ceil<TimerQueue::Clock::duration>(period);
+        if (timer_period <= TimerQueue::Clock::duration::zero())
+            throw std::invalid_argument{"ThreadPool: period must be positive"};
+
+        throw_if_closed_for_timers();
+
+        auto state = std::make_shared<detail::PeriodicState>();
+        state->timers = m_timers;
+        Promise<void> stopped{this};
+        auto f = stopped.get_future();
+
+        Run::schedule(Run{std::forward<Callable>(callable), state, std::move(stopped), timer_period, TimerQueue::Clock::now() + timer_period});
+
+        return PeriodicHandle{std::move(state), std::move(f)};
+    }
+
+    // Number of delayed and periodic tasks waiting for their due time
+    size_t timer_count() const
+    {
+        return m_timers->pending();
+    }
+
+    // Submits all callables from the range with a single lock acquisition and wakes at most as many
+    // sleeping workers as there are new tasks; futures are returned in the order of the range
+    template <std::ranges::input_range Callables>
+    auto submit_bulk(Callables&& callables)
+    {
+        return submit_bulk(Priority::normal, std::forward<Callables>(callables));
+    }
+
+    template <std::ranges::input_range Callables>
+    auto submit_bulk(Priority priority, Callables&& callables)
+    {
+        using Callable = std::ranges::range_value_t<Callables>;
+        using ResultT = std::invoke_result_t<Callable&>;
+
+        std::vector<Future<ResultT>> futures;
+        std::vector<Task> tasks;
+        if constexpr (std::ranges::sized_range<Callables>)
+        {
+            futures.reserve(std::ranges::size(callables));
+            tasks.reserve(std::ranges::size(callables));
+        }
+
+        for (auto&& callable : callables)
+        {
+            auto [task, f] = make_task(Callable(forward_element<Callables>(callable)));
+            futures.push_back(std::move(f));
+            tasks.push_back(std::move(task));
+        }
+
+        if (is_bounded_for_caller())
+        {
+            for (auto& task : tasks)
+                submit_task(std::move(task), priority); // the overflow policy applies to every task
+        }
+        else
+            push_tasks(tasks, priority);
+
+        return futures;
+    }
+
+    // Executor interface - continuations of pool futures (Future::then) are queued in the normal lane
+    void execute(Task task) override
+    {
+        try_push_task(task); // a shut down pool drops the continuation - it breaks its promise
+    }
+
+    // co_await pool.schedule() suspends the coroutine and resumes it on a worker of the pool.
+    // A resumption dropped by an aborted pool resumes the coroutine with std::future_error (broken_promise);
+    // scheduling on a shut down pool throws std::runtime_error from co_await.
+    auto schedule(Priority priority = Priority::normal)
+    {
+        class ScheduleAwaiter
+        {
+        public:
+            ScheduleAwaiter(ThreadPool& pool, Priority priority)
+                : m_pool{pool}
+                , m_priority{priority}
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                Task resumption{detail::Resumption{handle, &m_state}};
+                if (m_pool.try_push_task(resumption, m_priority))
+                    return;
+
+                m_state.armed = false; // not queued - the exception resumes the coroutine
+                if (m_pool.m_is_aborted.load())
+                    throw std::future_error{std::future_errc::broken_promise};
+                throw std::runtime_error{"ThreadPool: schedule after shutdown"};
+            }
+
+            void await_resume() const
+            {
+                if (m_state.dropped)
+                    throw std::future_error{std::future_errc::broken_promise};
+            }
+
+        private:
+            ThreadPool& m_pool;
+            Priority m_priority;
+            detail::Resumption::State m_state;
+        };
+
+        return ScheduleAwaiter{*this, priority};
+    }
+
+    bool is_worker_thread() const override
+    {
+        return tl_worker.pool == this;
+    }
+
+    // Runs one queued task on the calling thread; used by helping waits (Future::get(), parallel_for)
+    bool try_run_pending_task() override
+    {
+        QueuedTask entry;
+        if (!try_pop_task(entry))
+            return false;
+
+        run_task(entry);
+        return true;
+    }
+
+    // Helping wait for a std::future (e.g. from std::async) - pool futures help on their own
+    template <typename T>
+    void wait(const std::future<T>& f)
+    {
+        while (f.wait_for(std::chrono::seconds::zero()) != std::future_status::ready)
+        {
+            if (!try_run_pending_task())
+                f.wait_for(detail::help_poll_interval);
+        }
+    }
+
+    // Calls body(i) for every i in [first, last). The range is split lazily: a chunk of grain_size indexes is
+    // processed at a time and the rest is halved only when the pool is hungry, so unbalanced iterations still
+    // spread across workers. The calling thread takes part in the work - a thread outside the pool runs pieces
+    // of this range only, never other tasks of the pool. Exceptions are rethrown here.
+    template <std::integral Index, typename Body>
+    void parallel_for(Index first, Index last, Body&& body, Index grain_size = 0)
+    {
+        if (first >= last)
+            return;
+
+        auto range_body = [&body](Index chunk_first, Index chunk_last, Empty) {
+            for (Index i = chunk_first; i < chunk_last; ++i)
+                body(i);
+            return Empty{};
+        };
+
+        auto job = std::make_shared<RangeJob<Index, Empty, decltype(range_body)>>(*this, grain_size > 0 ? grain_size : default_grain_size(first, last), Empty{}, range_body);
+        job->run(first, last);
+        job->wait();
+    }
+
+    // Reduces [first, last): body(chunk_first, chunk_last, accumulator) returns the accumulator updated with
+    // the chunk, partial results of the pieces are merged with combine in index order (combine must be associative).
+    template <std::integral Index, typename T, typename RangeBody, typename Combine>
+    T parallel_reduce(Index first, Index last, const T& identity, RangeBody&& body, Combine&& combine, Index grain_size = 0)
+    {
+        if (first >= last)
+            return identity;
+
+        auto job = std::make_shared<RangeJob<Index, T, std::remove_reference_t<RangeBody>>>(*this, grain_size > 0 ? grain_size : default_grain_size(first, last), identity, body);
+        job->run(first, last);
+        job->wait();
+
+        return job->combine(combine);
+    }
+
+    // Current number of worker threads
+    unsigned int size() const
+    {
+        return m_thread_count.load(std::memory_order_relaxed);
+    }
+
+    unsigned int min_threads() const
+    {
+        return m_min_threads;
+    }
+
+    unsigned int max_threads() const
+    {
+        return m_max_threads;
+    }
+
+    bool is_elastic() const
+    {
+        return m_max_threads > m_min_threads;
+    }
+
+    // Counters and latency histograms of every worker slot (tasks run by helping non-worker threads are not counted);
+    // all zero when built with THREAD_POOL_METRICS=0
+    MetricsSnapshot snapshot() const
+    {
+        MetricsSnapshot result;
+#if THREAD_POOL_METRICS
+        result.workers.reserve(m_workers.size());
+        for (const auto& worker : m_workers)
+            result.workers.push_back(worker->metrics.snapshot());
+#else
+        result.workers.resize(m_workers.size());
+#endif
+
+        return result;
+    }
+
+    // CPU each running worker was last seen on (refreshed whenever it picks up work after sleeping)
+    std::vector<int> worker_cpus() const
+    {
+        std::lock_guard lk{m_mtx};
+
+        std::vector<int> cpus;
+        for (const auto& worker : m_workers)
+        {
+            if (worker->is_active)
+                cpus.push_back(worker->cpu.load(std::memory_order_relaxed));
+        }
+
+        return cpus;
+    }
+
+    Scheduling scheduling() const
+    {
+        return m_scheduling;
+    }
+
+    // 0 - unbounded
+    size_t queue_capacity() const
+    {
+        return m_queue_capacity;
+    }
+
+    // Largest number of tasks the shared queue has held
+    size_t queue_high_water_mark() const
+    {
+        std::lock_guard lk{m_mtx};
+        return m_high_water_mark;
+    }
+
+    // Number of tasks waiting in the lane; normal lane includes tasks in the deques of work-stealing workers
+    size_t queue_depth(Priority priority) const
+    {
+        size_t depth = m_lane_sizes[lane_index(priority)].load(std::memory_order_relaxed);
+
+        if (priority == Priority::normal)
+        {
+            for (const auto& worker : m_workers)
+                depth += worker->size.load(std::memory_order_relaxed);
+        }
+
+        return depth;
+    }
+
+    // Closes the pool for new external submissions and joins the workers. Tasks already running may still
+    // submit (e.g. nested fork/join) - in drain mode such tasks are run, in abort mode they are dropped.
+    // Delayed tasks that are not due yet are dropped in both modes and periodic tasks stop.
+    void shutdown(ShutdownMode mode = ShutdownMode::drain)
+    {
+        if (is_worker_thread())
+            throw std::logic_error{"ThreadPool::shutdown() called from a worker of the pool"};
+
+        std::lock_guard shutdown_lk{m_shutdown_mtx};
+
+        m_timers->stop();
+
+        std::vector<QueuedTask> dropped_tasks;
+        {
+            std::lock_guard lk{m_mtx};
+            m_is_closed = true;
+
+            if (mode == ShutdownMode::abort && !m_is_aborted.exchange(true))
+                dropped_tasks = take_all_queued_tasks();
+        }
+        m_cv_tasks.notify_all();
+        m_cv_supervisor.notify_all();
+        m_cv_space.notify_all();
+
+        dropped_tasks.clear(); // outside of the lock - destroyed promises wake up their waiters
+
+        if (m_supervisor.joinable())
+            m_supervisor.join(); // no new workers from now on
+
+        for (auto& thd : m_pool)
+        {
+            if (thd.joinable())
+                thd.join();
+        }
+    }
+
+    bool is_shut_down() const
+    {
+        std::lock_guard lk{m_mtx};
+        return m_is_closed;
+    }
+
+    // Futures of the pool outlive it: afterwards their continuations run inline and their waiters do not help
+    ~ThreadPool()
+    {
+        shutdown(ShutdownMode::drain);
+        detach_futures();
+    }
+
+private:
+    struct Empty
+    {
+    };
+
+    using EnqueueTime = std::conditional_t<metrics_enabled, std::chrono::steady_clock::time_point, Empty>;
+
+    struct QueuedTask
+    {
+        Task task;
+        [[no_unique_address]] EnqueueTime enqueued;
+    };
+
+    static_assert(metrics_enabled || sizeof(QueuedTask) == sizeof(Task), "compiled out metrics must not grow the queues");
+
+    struct alignas(cache_line_size) Worker
+    {
+        std::mutex mtx;
+        std::deque<QueuedTask> tasks;    // owner works at the back, thieves take from the front
+        std::atomic<size_t> size{0};     // lets thieves skip empty deques without locking
+        bool is_active = false;          // slot has a running thread (guarded by m_mtx)
+        std::atomic<int> cpu{-1};
+        unsigned int local_streak = 0;   // local pops since the shared queue was last looked at (owner only)
+        alignas(cache_line_size) [[no_unique_address]] std::conditional_t<metrics_enabled, WorkerMetrics, Empty> metrics;
+    };
+
+    struct WorkerContext
+    {
+        ThreadPool* pool;
+        size_t index;
+    };
+
+    static inline thread_local WorkerContext tl_worker; // zero-initialized - nullptr for non-worker threads
+
+    // Granularity of parallel_for/parallel_reduce chunks when no grain size is given
+    static constexpr unsigned int chunks_per_worker = 64;
+
+    // How many times in a row a non-empty lane may be passed over by higher priority lanes
+    static constexpr unsigned int starvation_limit = 8;
+
+    // Batch taken from the shared queue by a work-stealing worker, so the shared lock is not hit per task
+    static constexpr size_t max_batch_size = 32;
+
+    static constexpr size_t lane_index(Priority priority)
+    {
+        return static_cast<size_t>(priority);
+    }
+
+    // Normal priority tasks submitted by a work-stealing worker stay in its deque; everything else
+    // goes to the lanes of the shared queue
+    bool is_local_push(Priority priority) const
+    {
+        return priority == Priority::normal && m_scheduling == Scheduling::work_stealing && is_worker_thread();
+    }
+
+    static EnqueueTime enqueue_time()
+    {
+#if THREAD_POOL_METRICS
+        return std::chrono::steady_clock::now();
+#else
+        return {};
+#endif
+    }
+
+    // Submissions from outside the pool are limited by the capacity; workers are not - a worker blocked
+    // on a queue that only workers can drain would deadlock the pool
+    bool is_bounded_for_caller() const
+    {
+        return m_queue_capacity > 0 && !is_worker_thread();
+    }
+
+    // Entry point of submit(): applies the overflow policy when the shared queue of a bounded pool is full
+    void submit_task(Task task, Priority priority)
+    {
+        if (!is_bounded_for_caller())
+        {
+            push_task(std::move(task), priority);
+            return;
+        }
+
+        QueuedTask dropped; // destroyed outside of the lock - a dropped task breaks its promise
+        {
+            std::unique_lock lk{m_mtx};
+            if (m_is_aborted.load())
+                return;
+            throw_if_closed();
+
+            if (m_tasks_size.load(std::memory_order_relaxed) >= m_queue_capacity)
+            {
+                switch (m_overflow_policy)
+                {
+                case OverflowPolicy::block:
+                    ++m_blocked_submitters;
+                    m_cv_space.wait(lk, [this] { return m_tasks_size.load(std::memory_order_relaxed) < m_queue_capacity || m_is_closed; });
+                    --m_blocked_submitters;
+                    if (m_is_aborted.load())
+                        return;
+                    throw_if_closed();
+                    break;
+                case OverflowPolicy::reject:
+                    throw std::runtime_error{"ThreadPool: queue is full"};
+                case OverflowPolicy::caller_runs:
+                {
+                    lk.unlock();
+                    QueuedTask entry{std::move(task), enqueue_time()};
+                    run_task(entry);
+                    return;
+                }
+                case OverflowPolicy::drop_oldest:
+                    dropped = take_oldest_queued_task();
+                    break;
+                }
+            }
+
+            enqueue_shared(QueuedTask{std::move(task), enqueue_time()}, priority);
+        }
+
+        if (m_sleeping.load() > 0)
+            m_cv_tasks.notify_one();
+    }
+
+    // false, with the task left untouched, when the shared queue of a bounded pool is full
+    bool try_submit_task(Task& task, Priority priority)
+    {
+        if (!is_bounded_for_caller())
+        {
+            push_task(std::move(task), priority);
+            return true;
+        }
+
+        {
+            std::lock_guard lk{m_mtx};
+            if (m_is_aborted.load())
+            {
+                task = nullptr;
+                return true; // dropped like any task of an aborted pool
+            }
+            throw_if_closed();
+
+            if (m_tasks_size.load(std::memory_order_relaxed) >= m_queue_capacity)
+                return false;
+
+            enqueue_shared(QueuedTask{std::move(task), enqueue_time()}, priority);
+        }
+
+        if (m_sleeping.load() > 0)
+            m_cv_tasks.notify_one();
+
+        return true;
+    }
+
+    // Appends to a lane of the shared queue (called under m_mtx)
+    void enqueue_shared(QueuedTask entry, Priority priority)
+    {
+        auto& lane = m_lanes[lane_index(priority)];
+        lane.push_back(std::move(entry));
+        m_lane_sizes[lane_index(priority)].store(lane.size(), std::memory_order_relaxed);
+        m_high_water_mark = std::max(m_high_water_mark, m_tasks_size.fetch_add(1, std::memory_order_relaxed) + 1);
+        m_pending.fetch_add(1);
+    }
+
+    // Front of the lowest non-empty lane (called under m_mtx with a non-empty shared queue)
+    QueuedTask take_oldest_queued_task()
+    {
+        for (size_t lane = priority_count; lane-- > 0;)
+        {
+            if (m_lanes[lane].empty())
+                continue;
+
+            QueuedTask oldest = std::move(m_lanes[lane].front());
+            m_lanes[lane].pop_front();
+            m_lane_sizes[lane].store(m_lanes[lane].size(), std::memory_order_relaxed);
+            m_tasks_size.fetch_sub(1, std::memory_order_relaxed);
+            m_pending.fetch_sub(1);
+            return oldest;
+        }
+
+        return {};
+    }
+
+    void push_task(Task task, Priority priority = Priority::normal)
+    {
+        if (!try_push_task(task, priority) && !m_is_aborted.load())
+            throw std::runtime_error{"ThreadPool: submit after shutdown"};
+    } // an aborted pool drops the task - a dropped task breaks its promise
+
+    // false, with the task left untouched, when the pool is aborted or closed for the calling thread
+    bool try_push_task(Task& task, Priority priority = Priority::normal)
+    {
+        if (m_is_aborted.load())
+            return false;
+
+        const EnqueueTime enqueued = enqueue_time();
+
+        if (is_local_push(priority))
+        {
+            m_pending.fetch_add(1); // before the task is visible - m_pending never underflows
+
+            Worker& worker = *m_workers[tl_worker.index];
+            {
+                std::lock_guard lk{worker.mtx};
+                worker.tasks.push_back(QueuedTask{std::move(task), enqueued});
+                worker.size.store(worker.tasks.size(), std::memory_order_relaxed);
+            }
+
+            if (m_sleeping.load() > 0)
+            {
+                { std::lock_guard lk{m_mtx}; } // sleeper is either before its predicate check or inside wait()
+                m_cv_tasks.notify_one();
+            }
+        }
+        else
+        {
+            {
+                std::lock_guard lk{m_mtx};
+                if (is_closed_for_caller())
+                    return false;
+                enqueue_shared(QueuedTask{std::move(task), enqueued}, priority);
+            }
+
+            if (m_sleeping.load() > 0)
+                m_cv_tasks.notify_one();
+        }
+
+        return true;
+    }
+
+    void push_tasks(std::vector<Task>& tasks, Priority priority = Priority::normal)
+    {
+        if (tasks.empty() || m_is_aborted.load())
+            return;
+
+        const auto as_queued = [enqueued = enqueue_time()](Task& task) { return QueuedTask{std::move(task), enqueued}; };
+
+        if (is_local_push(priority))
+        {
+            m_pending.fetch_add(tasks.size());
+
+            Worker& worker = *m_workers[tl_worker.index];
+            {
+                std::lock_guard lk{worker.mtx};
+                std::ranges::transform(tasks, std::back_inserter(worker.tasks), as_queued);
+                worker.size.store(worker.tasks.size(), std::memory_order_relaxed);
+            }
+
+            if (m_sleeping.load() > 0)
+            {
+                { std::lock_guard lk{m_mtx}; }
+                wake_workers(tasks.size());
+            }
+        }
+        else
+        {
+            {
+                std::lock_guard lk{m_mtx};
+                throw_if_closed();
+                auto& lane = m_lanes[lane_index(priority)];
+                std::ranges::transform(tasks, std::back_inserter(lane), as_queued);
+                m_lane_sizes[lane_index(priority)].store(lane.size(), std::memory_order_relaxed);
+                m_high_water_mark = std::max(m_high_water_mark, m_tasks_size.fetch_add(tasks.size(), std::memory_order_relaxed) + tasks.size());
+                m_pending.fetch_add(tasks.size());
+            }
+
+            if (m_sleeping.load() > 0)
+                wake_workers(tasks.size());
+        }
+    }
+
+    // After shutdown only workers (running tasks that fork more work) may submit (called under m_mtx)
+    bool is_closed_for_caller() const
+    {
+        return m_is_closed && !is_worker_thread();
+    }
+
+    void throw_if_closed() const
+    {
+        if (is_closed_for_caller())
+            throw std::runtime_error{"ThreadPool: submit after shutdown"};
+    }
+
+    void throw_if_closed_for_timers() const
+    {
+        std::lock_guard lk{m_mtx};
+        throw_if_closed();
+    }
+
+    template <typename Clock, typename Duration>
+    static TimerQueue::Clock::time_point to_timer_clock(std::chrono::time_point<Clock, Duration> time)
+    {
+        if constexpr (std::is_same_v<Clock, TimerQueue::Clock>)
+            return std::chrono::ceil<TimerQueue::Clock::duration>(time);
+        else
+            return TimerQueue::Clock::now() + std::chrono::ceil<TimerQueue::Clock::duration>(time - Clock::now());
+    }
+
+    // Removes every queued task from the lanes and worker deques (called under m_mtx)
+    std::vector<QueuedTask> take_all_queued_tasks()
+    {
+        std::vector<QueuedTask> tasks;
+
+        for (size_t lane = 0; lane < priority_count; ++lane)
+        {
+            std::ranges::move(m_lanes[lane], std::back_inserter(tasks));
+            m_lanes[lane].clear();
+            m_lane_sizes[lane].store(0, std::memory_order_relaxed);
+        }
+        m_tasks_size.store(0, std::memory_order_relaxed);
+
+        for (auto& worker : m_workers)
+        {
+            std::lock_guard worker_lk{worker->mtx};
+            std::ranges::move(worker->tasks, std::back_inserter(tasks));
+            worker->tasks.clear();
+            worker->size.store(0, std::memory_order_relaxed);
+        }
+
+        m_pending.fetch_sub(tasks.size());
+
+        return tasks;
+    }
+
+    void wake_workers(size_t task_count)
+    {
+        if (task_count >= m_sleeping.load())
+        {
+            m_cv_tasks.notify_all();
+            return;
+        }
+
+        for (size_t i = 0; i < task_count; ++i)
+            m_cv_tasks.notify_one();
+    }
+
+    // copies elements of lvalue containers, moves out of rvalue containers and temporaries produced by views
+    template <typename Range, typename Element>
+    static decltype(auto) forward_element(Element& element)
+    {
+        if constexpr (std::is_lvalue_reference_v<Range> && std::is_lvalue_reference_v<std::ranges::range_reference_t<Range>>)
+            return static_cast<const Element&>(element);
+        else
+            return std::move(element);
+    }
+
+    bool try_pop_local(QueuedTask& task)
+    {
+        if (!is_worker_thread())
+            return false;
+
+        Worker& worker = *m_workers[tl_worker.index];
+        if (worker.size.load(std::memory_order_relaxed) == 0)
+            return false;
+
+        std::lock_guard lk{worker.mtx};
+        if (worker.tasks.empty())
+            return false;
+
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        worker.size.store(worker.tasks.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    // Highest non-empty lane, unless a lower non-empty lane has been passed over too often (called under m_mtx)
+    size_t select_lane()
+    {
+        size_t selected = priority_count;
+        for (size_t lane = 0; lane < priority_count; ++lane)
+        {
+            if (m_lanes[lane].empty())
+                continue;
+
+            if (selected == priority_count)
+                selected = lane;
+            else if (++m_lane_skips[lane] > starvation_limit && m_lane_skips[lane] > m_lane_skips[selected])
+                selected = lane;
+        }
+
+        if (selected != priority_count)
+            m_lane_skips[selected] = 0;
+
+        return selected;
+    }
+
+    bool try_pop_shared(QueuedTask& task)
+    {
+        if (m_tasks_size.load(std::memory_order_relaxed) == 0)
+            return false;
+
+        std::lock_guard lk{m_mtx};
+        const size_t selected = select_lane();
+        if (selected == priority_count)
+            return false;
+
+        auto& lane = m_lanes[selected];
+        task = std::move(lane.front());
+        lane.pop_front();
+        size_t taken = 1;
+
+        if (selected == lane_index(Priority::normal) && m_scheduling == Scheduling::work_stealing && is_worker_thread() && !lane.empty())
+        {
+            // move a fair share of the backlog to the local deque - other workers may steal it from there
+            const size_t batch_size = std::min(lane.size() / size(), max_batch_size);
+            if (batch_size > 0)
+            {
+                Worker& worker = *m_workers[tl_worker.index];
+                std::lock_guard worker_lk{worker.mtx};
+                for (size_t i = 0; i < batch_size; ++i)
+                {
+                    worker.tasks.push_front(std::move(lane.front()));
+                    lane.pop_front();
+                }
+                worker.size.store(worker.tasks.size(), std::memory_order_relaxed);
+                taken += batch_size;
+            }
+        }
+
+        m_lane_sizes[selected].store(lane.size(), std::memory_order_relaxed);
+        m_tasks_size.fetch_sub(taken, std::memory_order_relaxed);
+
+        if (m_blocked_submitters > 0)
+            m_cv_space.notify_all();
+
+        return true;
+    }
+
+    bool try_steal(QueuedTask& task)
+    {
+        // workers start with their neighbour and skip themselves; other threads (helping callers) scan all deques
+        const size_t first_victim = is_worker_thread() ? tl_worker.index + 1 : 0;
+        const size_t victim_count = is_worker_thread() ? m_workers.size() - 1 : m_workers.size();
+
+        for (size_t offset = 0; offset < victim_count; ++offset)
+        {
+            Worker& victim = *m_workers[(first_victim + offset) % m_workers.size()];
+            if (victim.size.load(std::memory_order_relaxed) == 0)
+                continue;
+
+            std::unique_lock lk{victim.mtx, std::try_to_lock};
+            if (!lk.owns_lock() || victim.tasks.empty())
+                continue;
+
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            victim.size.store(victim.tasks.size(), std::memory_order_relaxed);
+
+#if THREAD_POOL_METRICS
+            if (is_worker_thread())
+                m_workers[tl_worker.index]->metrics.record_steal();
+#endif
+            return true;
+        }
+
+        return false;
+    }
+
+    bool try_pop_task(QueuedTask& task)
+    {
+        bool found = false;
+
+        if (m_scheduling == Scheduling::work_stealing)
+        {
+            // high priority tasks in the shared queue go before the local backlog, and so does the shared queue
+            // after starvation_limit local pops in a row - a worker feeding itself must not starve the lanes
+            unsigned int* local_streak = is_worker_thread() ? &m_workers[tl_worker.index]->local_streak : nullptr;
+            const bool has_urgent = m_lane_sizes[lane_index(Priority::high)].load(std::memory_order_relaxed) > 0;
+            const bool is_shared_due = has_urgent || (local_streak && *local_streak >= starvation_limit);
+            if (is_shared_due && local_streak)
+                *local_streak = 0;
+
+            found = (is_shared_due && try_pop_shared(task));
+            if (!found && try_pop_local(task))
+            {
+                found = true;
+                if (local_streak)
+                    ++*local_streak;
+            }
+            found = found || try_pop_shared(task) || try_steal(task);
+        }
+        else
+            found = try_pop_shared(task);
+
+        if (found)
+            m_pending.fetch_sub(1);
+
+        return found;
+    }
+
+    void run_task(QueuedTask& entry)
+    {
+        if (m_is_aborted.load(std::memory_order_relaxed)) // a task pushed while the pool was aborted is dropped
+        {
+            entry.task = nullptr;
+            return;
+        }
+
+#if THREAD_POOL_METRICS
+        if (is_worker_thread())
+        {
+            const auto start = std::chrono::steady_clock::now();
+            invoke_task(entry.task);
+            const auto end = std::chrono::steady_clock::now();
+            m_workers[tl_worker.index]->metrics.record_task(start - entry.enqueued, end - start);
+            entry.task = nullptr;
+            return;
+        }
+#endif
+
+        invoke_task(entry.task);
+        entry.task = nullptr;
+    }
+
+    // Only posted tasks throw - submitted ones keep their exceptions in their futures
+    void invoke_task(Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            m_exception_handler(std::current_exception());
+        }
+    }
+
+    void invoke_worker_hook(const std::function<void(size_t)>& hook, size_t index)
+    {
+        if (!hook)
+            return;
+
+        try
+        {
+            hook(index);
+        }
+        catch (...)
+        {
+            m_exception_handler(std::current_exception());
+        }
+    }
+
+    static void report_uncaught_exception(std::exception_ptr eptr)
+    {
+        try
+        {
+            std::rethrow_exception(eptr);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "ThreadPool: uncaught exception in a posted task or a worker hook: " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "ThreadPool: uncaught exception in a posted task or a worker hook" << std::endl;
+        }
+    }
+
+    // Task that stores the result of callable (or its exception) in the returned future
+    template <typename Callable>
+    auto make_task(Callable&& callable)
+    {
+        using ResultT = std::invoke_result_t<std::decay_t<Callable>&>;
+
+        Promise<ResultT> promise{this};
+        Future<ResultT> f = promise.get_future();
+
+        Task task{[promise = std::move(promise), callable = std::forward<Callable>(callable)]() mutable { promise.set_from(callable); }};
+
+        return std::pair{std::move(task), std::move(f)};
+    }
+
+    template <typename Callable>
+    auto make_stoppable_task(std::stop_token token, Callable&& callable)
+    {
+        using F = std::decay_t<Callable>;
+        using ResultT = typename detail::StoppableResult<F>::type;
+
+        Promise<ResultT> promise{this};
+        Future<ResultT> f = promise.get_future();
+
+        Task task{[promise = std::move(promise), callable = std::forward<Callable>(callable), token = std::move(token)]() mutable {
+            if (token.stop_requested())
+                return; // skipped - the promise is broken when the task is destroyed
+
+            if constexpr (detail::takes_stop_token<F>)
+            {
+                auto bound = [&callable, &token] { return std::invoke(callable, token); };
+                promise.set_from(bound);
+            }
+            else
+                promise.set_from(callable);
+        }};
+
+        return std::pair{std::move(task), std::move(f)};
+    }
+
+    // Lazy splitting heuristic: split only when the queued work may not keep every worker busy.
+    // A work-stealing worker whose deque is empty had its previous splits stolen, so others are hungry.
+    bool is_hungry() const
+    {
+        if (m_scheduling == Scheduling::work_stealing && is_worker_thread())
+            return m_workers[tl_worker.index]->size.load(std::memory_order_relaxed) == 0;
+
+        return m_pending.load(std::memory_order_relaxed) < size();
+    }
+
+    // Forked parts of the range wait in the job's own list; the pool gets a ticket per part that runs whichever part
+    // is still unclaimed. So the caller can help with the pieces of its own job only and a ticket that comes late
+    // (or is dropped) finds nothing to do. Tickets share the ownership of the job - the caller may return first.
+    template <typename Index, typename T, typename RangeBody>
+    class RangeJob : public std::enable_shared_from_this<RangeJob<Index, T, RangeBody>>
+    {
+    public:
+        RangeJob(ThreadPool& pool, Index grain_size, const T& identity, RangeBody& body)
+            : m_pool{pool}
+            , m_grain_size{grain_size}
+            , m_identity{identity}
+            , m_body{body}
+        {
+        }
+
+        // Processes [first, last) chunk by chunk; whenever the pool is hungry the upper half of the rest is forked
+        void run(Index first, Index last)
+        {
+            const Index piece_first = first;
+            T result = m_identity;
+
+            try
+            {
+                while (first < last && !m_failed.load(std::memory_order_relaxed))
+                {
+                    if (last - first > m_grain_size && m_pool.is_hungry())
+                    {
+                        const Index middle = first + (last - first) / 2;
+                        fork(middle, last);
+                        last = middle;
+                        continue;
+                    }
+
+                    const Index chunk_last = (last - first > m_grain_size) ? first + m_grain_size : last;
+                    result = m_body(first, chunk_last, std::move(result));
+                    first = chunk_last;
+                }
+
+                std::lock_guard lk{m_mtx};
+                m_partial_results.emplace_back(piece_first, std::move(result));
+            }
+            catch (...)
+            {
+                std::lock_guard lk{m_mtx};
+                if (!m_eptr)
+                    m_eptr = std::current_exception();
+                m_failed = true;
+            }
+
+            finish_piece();
+        }
+
+        // The calling thread runs the unclaimed pieces of this job until every piece is finished. A worker
+        // may run other tasks of its pool meanwhile; any other thread blocks instead of picking up unrelated work.
+        void wait()
+        {
+            const bool is_worker = m_pool.is_worker_thread();
+
+            while (m_pending.load() > 0)
+            {
+                if (run_unclaimed_piece())
+                    continue;
+
+                if (is_worker && m_pool.try_run_pending_task())
+                    continue;
+
+                std::unique_lock lk{m_mtx};
+                m_cv_done.wait_for(lk, detail::help_poll_interval, [this] { return m_pending.load() == 0 || !m_unclaimed.empty(); });
+            }
+
+            std::lock_guard lk{m_mtx};
+            if (m_eptr)
+                std::rethrow_exception(m_eptr);
+        }
+
+        template <typename Combine>
+        T combine(Combine& combine_op)
+        {
+            std::ranges::sort(m_partial_results, {}, [](const auto& partial) { return partial.first; });
+
+            T result = m_identity;
+            for (auto& [first, partial] : m_partial_results)
+                result = combine_op(std::move(result), std::move(partial));
+
+            return result;
+        }
+
+    private:
+        void fork(Index first, Index last)
+        {
+            m_pending.fetch_add(1);
+            {
+                std::lock_guard lk{m_mtx};
+                m_unclaimed.emplace_back(first, last);
+            }
+
+            Task ticket{[job = this->shared_from_this()] { job->run_unclaimed_piece(); }};
+            m_pool.try_push_task(ticket); // a piece the pool does not take is run by the waiting caller
+        }
+
+        bool run_unclaimed_piece()
+        {
+            std::pair<Index, Index> piece;
+            {
+                std::lock_guard lk{m_mtx};
+                if (m_unclaimed.empty())
+                    return false;
+
+                piece = m_unclaimed.back();
+                m_unclaimed.pop_back();
+            }
+
+            run(piece.first, piece.second);
+            return true;
+        }
+
+        void finish_piece()
+        {
+            std::lock_guard lk{m_mtx};
+            if (m_pending.fetch_sub(1) == 1)
+                m_cv_done.notify_all();
+        }
+
+        ThreadPool& m_pool;
+        const Index m_grain_size;
+        const T m_identity;
+        RangeBody& m_body; // used only while a piece is pending - the caller is still waiting then
+        std::atomic<size_t> m_pending{1}; // pieces not finished yet, claimed or not
+        std::atomic<bool> m_failed{false};
+        std::mutex m_mtx;
+        std::condition_variable m_cv_done;
+        std::exception_ptr m_eptr;
+        std::vector<std::pair<Index, Index>> m_unclaimed;
+        std::vector<std::pair<Index, T>> m_partial_results;
+    };
+
+    // Computed in size_t - a narrow Index (e.g. int16_t) could not hold size() * chunks_per_worker
+    template <typename Index>
+    Index default_grain_size(Index first, Index last) const
+    {
+        using Unsigned = std::make_unsigned_t<Index>;
+        const auto length = static_cast<size_t>(static_cast<Unsigned>(static_cast<Unsigned>(last) - static_cast<Unsigned>(first)));
+        return static_cast<Index>(std::max<size_t>(1, length / (size_t{size()} * chunks_per_worker)));
+    }
+
+    void Run_(size_t index)
+    {
+        tl_worker = {this, index};
+
+        if (!m_cpus.empty())
+            pin_current_thread(m_pin_each_worker ? std::vector{m_cpus[index % m_cpus.size()]} : m_cpus);
+
+        Worker& worker = *m_workers[index];
+        worker.cpu.store(current_cpu(), std::memory_order_relaxed);
+
+        invoke_worker_hook(m_on_worker_start, index);
+
+        QueuedTask entry;
+        while (true)
+        {
+            if (try_pop_task(entry))
+            {
+                m_started_tasks.fetch_add(1, std::memory_order_relaxed);
+                run_task(entry);
+                continue;
+            }
+
+            [[maybe_unused]] const EnqueueTime idle_start = enqueue_time();
+            std::unique_lock lk{m_mtx};
+            m_sleeping.fetch_add(1);
+            bool has_work = true;
+            if (is_elastic())
+                has_work = m_cv_tasks.wait_for(lk, m_idle_timeout, [this] { return m_pending.load() > 0 || m_is_closed; });
+            else
+                m_cv_tasks.wait(lk, [this] { return m_pending.load() > 0 || m_is_closed; });
+            m_sleeping.fetch_sub(1);
+            worker.cpu.store(current_cpu(), std::memory_order_relaxed);
+#if THREAD_POOL_METRICS
+            worker.metrics.record_idle(std::chrono::steady_clock::now() - idle_start);
+#endif
+
+            if (m_is_closed && m_pending.load() == 0)
+                break;
+
+            // idle extra thread retires - its deque is empty, only the owner pushes to it
+            if (!has_work && m_thread_count.load() > m_min_threads)
+            {
+                worker.is_active = false;
+                m_thread_count.fetch_sub(1);
+                break;
+            }
+        }
+
+        // the slot is reused only after this thread is joined, so hooks of one index never overlap
+        invoke_worker_hook(m_on_worker_stop, index);
+    }
+
+    // Elastic pool: adds a thread when tasks are queued, nobody is idle and no task was started for stall_timeout,
+    // i.e. the workers are blocked (I/O, sleeps, waits) rather than busy with short CPU-bound tasks
+    void Supervise_()
+    {
+        size_t last_started = m_started_tasks.load(std::memory_order_relaxed);
+
+        std::unique_lock lk{m_mtx};
+        while (!m_is_closed)
+        {
+            if (m_cv_supervisor.wait_for(lk, m_stall_timeout, [this] { return m_is_closed; }))
+                break;
+
+            const size_t started = m_started_tasks.load(std::memory_order_relaxed);
+            const bool is_stalled = started == last_started && m_pending.load() > 0 && m_sleeping.load() == 0;
+            last_started = started;
+
+            if (!is_stalled || m_thread_count.load() >= m_max_threads)
+                continue;
+
+            const auto slot = std::ranges::find_if(m_workers, [](const auto& worker) { return !worker->is_active; }) - m_workers.begin();
+            m_workers[slot]->is_active = true;
+            m_thread_count.fetch_add(1);
+
+            lk.unlock();
+            if (m_pool[slot].joinable())
+                m_pool[slot].join(); // thread that retired from the slot earlier
+            m_pool[slot] = std::thread([this, slot] { Run_(slot); });
+            lk.lock();
+        }
+    }
+
+    const unsigned int m_min_threads;
+    const unsigned int m_max_threads;
+    const Scheduling m_scheduling;
+    const std::chrono::milliseconds m_idle_timeout;
+    const std::chrono::milliseconds m_stall_timeout;
+    const std::vector<int> m_cpus;
+    const bool m_pin_each_worker;
+    const size_t m_queue_capacity;
+    const OverflowPolicy m_overflow_policy;
+    const std::function<void(std::exception_ptr)> m_exception_handler;
+    const std::function<void(size_t)> m_on_worker_start;
+    const std::function<void(size_t)> m_on_worker_stop;
+    std::vector<std::unique_ptr<Worker>> m_workers; // one slot per potential thread (max_threads)
+    std::vector<std::thread> m_pool;
+    std::atomic<unsigned int> m_thread_count{0};
+    std::atomic<size_t> m_started_tasks{0};
+    std::thread m_supervisor;
+    std::condition_variable m_cv_supervisor;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv_tasks;
+    std::array<std::deque<QueuedTask>, priority_count> m_lanes;
+    std::array<std::atomic<size_t>, priority_count> m_lane_sizes{};
+    std::array<unsigned int, priority_count> m_lane_skips{};
+    std::atomic<size_t> m_tasks_size{0}; // all lanes of the shared queue
+    size_t m_high_water_mark{0};
+    std::condition_variable m_cv_space; // bounded pool: a blocked submitter waits for room in the shared queue
+    size_t m_blocked_submitters{0};
+    std::atomic<size_t> m_pending{0}; // queued in the shared queue and in all worker deques
+    std::atomic<unsigned int> m_sleeping{0};
+    bool m_is_closed{false};
+    std::atomic<bool> m_is_aborted{false};
+    std::mutex m_shutdown_mtx;
+    std::shared_ptr<TimerQueue> m_timers = std::make_shared<TimerQueue>(*this); // shared with the handles of periodic tasks
+};
+
+#endif // THREAD_POOL_HPP
@@ -1,10 +1,18 @@
 #ifndef THREAD_SAFE_QUEUE_HPP
 #define THREAD_SAFE_QUEUE_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <stdexcept>
+#include <utility>
 
+// After close() pushes throw std::runtime_error; pops drain the items left and then report the queue
+// as closed instead of waiting (false, an empty optional or 0 items) - consumers stop without poison pills.
 template <typename T>
 class ThreadSafeQueue
 {
@@ -22,6 +30,7 @@ public:
     {
         {
             std::unique_lock lock(m_mutexQueue);
+            throw_if_closed();
             m_queue.push(item);
         }
 
@@ -32,24 +41,53 @@ public:
     {
         {
             std::unique_lock lock(m_mutexQueue);
+            throw_if_closed();
             m_queue.push(std::move(item));
         }
 
         m_cvQueueNotEmpty.notify_one();
     }
 
+    // Constructs the item in place - nothing is copied or moved into the queue
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        {
+            std::unique_lock lock(m_mutexQueue);
+            throw_if_closed();
+            m_queue.emplace(std::forward<Args>(args)...);
+        }
+
+        m_cvQueueNotEmpty.notify_one();
+    }
+
     void push(std::initializer_list<T> initializerList)
     {
+        push_range(initializerList.begin(), initializerList.end());
+    }
+
+    // All items are pushed under one lock; one waiting consumer is woken per item, at most all of them.
+    // Items are constructed from *first, so std::make_move_iterator moves them into the queue.
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last)
+    {
+        size_t wakeups = 0;
         {
             std::unique_lock<std::mutex> lock(m_mutexQueue);
-            for (auto& item : initializerList)
+            throw_if_closed();
+            size_t count = 0;
+            for (; first != last; ++first, ++count)
             {
-                m_queue.push(item);
+                m_queue.emplace(*first);
             }
-        }        
-        m_cvQueueNotEmpty.notify_all();
+            wakeups = std::min(count, m_waitingConsumers);
+        }
+
+        for (; wakeups > 0; --wakeups)
+            m_cvQueueNotEmpty.notify_one();
     }
 
+    // Items are moved out of the queue - the lock is held for a move instead of a copy
     bool try_pop(T& item)
     {
         std::unique_lock<std::mutex> lock(m_mutexQueue, std::try_to_lock);        
@@ -58,23 +96,163 @@ public:
             return false;
         }
 
-        item = m_queue.front();
+        item = std::move(m_queue.front());
         m_queue.pop();
         return true;
     }
 
-    void pop(T& item)
+    std::optional<T> try_pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutexQueue, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return std::nullopt;
+        }
+
+        return take_front();
+    }
+
+    // false - the queue is closed and empty
+    bool pop(T& item)
     {
         std::unique_lock<std::mutex> lock(m_mutexQueue);
-        m_cvQueueNotEmpty.wait(lock, [&] { return !m_queue.empty(); });
+        wait_not_empty(lock);
+        if (m_queue.empty())
+        {
+            return false;
+        }
 
-        item = m_queue.front();
+        item = std::move(m_queue.front());
         m_queue.pop();        
+        return true;
+    }
+
+    // Waits for an item; T does not have to be default constructible. Empty - the queue is closed and empty.
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutexQueue);
+        wait_not_empty(lock);
+
+        return take_front();
+    }
+
+    // Empty - timed out, or the queue is closed and empty (see is_closed())
+    template <typename Rep, typename Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutexQueue);
+        wait_not_empty_until(lock, std::chrono::steady_clock::now() + timeout);
+
+        return take_front();
+    }
+
+    template <typename Clock, typename Duration>
+    std::optional<T> pop_until(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        std::unique_lock<std::mutex> lock(m_mutexQueue);
+        wait_not_empty_until(lock, deadline);
+
+        return take_front();
+    }
+
+    // Waits for an item and takes the whole queue with one lock acquisition - the queue is swapped out and
+    // the items are moved to out after the lock is released. Returns the number of items (0 - closed and empty).
+    template <typename OutputIt>
+    size_t pop_all(OutputIt out)
+    {
+        std::queue<T> items;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexQueue);
+            wait_not_empty(lock);
+            std::swap(items, m_queue);
+        }
+
+        const size_t count = items.size();
+        for (; !items.empty(); items.pop())
+        {
+            *out++ = std::move(items.front());
+        }
+        return count;
+    }
+
+    // Waits for an item and takes at most n items with one lock acquisition; they are moved to out
+    // under the lock, so out should not be expensive to write to. Returns the number of items (0 - closed and empty).
+    template <typename OutputIt>
+    size_t pop_up_to(size_t n, OutputIt out)
+    {
+        if (n == 0)
+            return 0;
+
+        std::unique_lock<std::mutex> lock(m_mutexQueue);
+        wait_not_empty(lock);
+
+        const size_t count = std::min(n, m_queue.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            *out++ = std::move(m_queue.front());
+            m_queue.pop();
+        }
+        return count;
+    }
+
+    // Wakes up all waiting consumers; idempotent
+    void close()
+    {
+        {
+            std::lock_guard lock(m_mutexQueue);
+            m_isClosed = true;
+        }
+
+        m_cvQueueNotEmpty.notify_all();
     }
+
+    bool is_closed()
+    {
+        std::lock_guard lock(m_mutexQueue);
+        return m_isClosed;
+    }
+
 private:
+    void throw_if_closed() const
+    {
+        if (m_isClosed)
+            throw std::runtime_error{"ThreadSafeQueue: push to a closed queue"};
+    }
+
+    // Called with the lock held; waiters are counted so that push_range wakes no more of them than it has items for
+    void wait_not_empty(std::unique_lock<std::mutex>& lock)
+    {
+        ++m_waitingConsumers;
+        m_cvQueueNotEmpty.wait(lock, [&] { return !m_queue.empty() || m_isClosed; });
+        --m_waitingConsumers;
+    }
+
+    template <typename Clock, typename Duration>
+    void wait_not_empty_until(std::unique_lock<std::mutex>& lock, const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        ++m_waitingConsumers;
+        m_cvQueueNotEmpty.wait_until(lock, deadline, [&] { return !m_queue.empty() || m_isClosed; });
+        --m_waitingConsumers;
+    }
+
+    // Called with the lock held
+    std::optional<T> take_front()
+    {
+        if (m_queue.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::optional<T> item{std::move(m_queue.front())};
+        m_queue.pop();
+        return item;
+    }
+
     std::queue<T> m_queue;
     std::mutex m_mutexQueue;
     std::condition_variable m_cvQueueNotEmpty;
+    bool m_isClosed = false;
+    size_t m_waitingConsumers = 0;
 };
 
 #endif // THREAD_SAFE_QUEUE_HPP
@@ -0,0 +1,305 @@
+#ifndef TIMER_QUEUE_HPP
+#define TIMER_QUEUE_HPP
+
+#include "future.hpp"
+#include "task.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Tasks waiting for their due time in a min-heap serviced by a single timer thread. A due task is handed
+// to the executor, so no worker sleeps through a delay and pending timers cost one heap entry each.
+// The thread is started by the first scheduled task.
+class TimerQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::uint64_t;
+
+    explicit TimerQueue(Executor& executor)
+        : m_executor{executor}
+    {
+    }
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    ~TimerQueue()
+    {
+        stop();
+    }
+
+    // After stop() the task is destroyed unrun - a dropped task breaks its promise
+    TimerId schedule(Clock::time_point due, Task task)
+    {
+        std::unique_lock lk{m_mtx};
+        if (m_is_stopped)
+        {
+            lk.unlock();
+            task = nullptr;
+            return 0;
+        }
+
+        if (!m_thread.joinable())
+            m_thread = std::thread([this] { Run_(); });
+
+        const TimerId id = ++m_last_id;
+        m_timers.push_back(Timer{due, id, std::move(task)});
+        std::push_heap(m_timers.begin(), m_timers.end(), is_later);
+        const bool is_earliest = m_timers.front().id == id;
+        lk.unlock();
+
+        if (is_earliest)
+            m_cv_timers.notify_one();
+
+        return id;
+    }
+
+    // Destroys the task unrun; false when it is no longer pending (already due, cancelled or unknown)
+    bool cancel(TimerId id)
+    {
+        Task cancelled;
+        {
+            std::lock_guard lk{m_mtx};
+            const auto it = std::ranges::find(m_timers, id, &Timer::id);
+            if (it == m_timers.end())
+                return false;
+
+            cancelled = std::move(it->task);
+            m_timers.erase(it);
+            std::make_heap(m_timers.begin(), m_timers.end(), is_later);
+        }
+
+        return true; // cancelled task is destroyed outside of the lock
+    }
+
+    size_t pending() const
+    {
+        std::lock_guard lk{m_mtx};
+        return m_timers.size();
+    }
+
+    // Joins the timer thread and drops all pending tasks; later schedules drop their tasks at once
+    void stop()
+    {
+        std::vector<Timer> dropped;
+        {
+            std::lock_guard lk{m_mtx};
+            m_is_stopped = true;
+            dropped = std::move(m_timers);
+            m_timers.clear();
+        }
+        m_cv_timers.notify_all();
+
+        if (m_thread.joinable())
+            m_thread.join();
+
+        dropped.clear(); // outside of the lock - destroyed promises wake up their waiters
+    }
+
+private:
+    struct Timer
+    {
+        Clock::time_point due;
+        TimerId id; // ties are broken in scheduling order
+        Task task;
+    };
+
+    static bool is_later(const Timer& lhs, const Timer& rhs)
+    {
+        return std::tie(lhs.due, lhs.id) > std::tie(rhs.due, rhs.id);
+    }
+
+    void Run_()
+    {
+        std::vector<Task> due_tasks;
+
+        std::unique_lock lk{m_mtx};
+        while (!m_is_stopped)
+        {
+            if (m_timers.empty())
+            {
+                m_cv_timers.wait(lk);
+                continue;
+            }
+
+            const auto now = Clock::now();
+            const auto next_due = m_timers.front().due; // a copy - the heap may reallocate while waiting
+            if (next_due > now)
+            {
+                m_cv_timers.wait_until(lk, next_due);
+                continue;
+            }
+
+            while (!m_timers.empty() && m_timers.front().due <= now)
+            {
+                std::pop_heap(m_timers.begin(), m_timers.end(), is_later);
+                due_tasks.push_back(std::move(m_timers.back().task));
+                m_timers.pop_back();
+            }
+
+            lk.unlock();
+            for (auto& task : due_tasks)
+                m_executor.execute(std::move(task));
+            due_tasks.clear();
+            lk.lock();
+        }
+    }
+
+    Executor& m_executor;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv_timers;
+    std::vector<Timer> m_timers; // min-heap on (due, id)
+    TimerId m_last_id = 0;
+    bool m_is_stopped = false;
+    std::thread m_thread;
+};
+
+namespace detail
+{
+    // Shared by a periodic task and its handle
+    struct PeriodicState
+    {
+        std::weak_ptr<TimerQueue> timers; // the pool owns the queue - a handle may outlive it
+        std::atomic<bool> is_cancelled{false};
+        std::atomic<TimerQueue::TimerId> timer_id{0}; // of the next run
+    };
+} // namespace detail
+
+// Handle of a task submitted with ThreadPool::submit_every
+class PeriodicHandle
+{
+public:
+    PeriodicHandle() = default;
+
+    // No run starts after cancel() returns (a run in progress completes); stopped() becomes ready.
+    // Once the pool is destroyed the task has stopped already and cancel() only marks the handle.
+    void cancel()
+    {
+        if (!m_state || m_state->is_cancelled.exchange(true))
+            return;
+
+        if (auto timers = m_state->timers.lock())
+            timers->cancel(m_state->timer_id.load());
+    }
+
+    bool is_cancelled() const
+    {
+        return m_state && m_state->is_cancelled.load();
+    }
+
+    // Ready when the task will not run again: cancelled or its pool shut down (value), or a run threw (exception)
+    Future<void>& stopped()
+    {
+        return m_stopped;
+    }
+
+private:
+    friend class ThreadPool;
+
+    PeriodicHandle(std::shared_ptr<detail::PeriodicState> state, Future<void> stopped)
+        : m_state{std::move(state)}
+        , m_stopped{std::move(stopped)}
+    {
+    }
+
+    std::shared_ptr<detail::PeriodicState> m_state;
+    Future<void> m_stopped;
+};
+
+namespace detail
+{
+    // One run of a periodic task that schedules the next one. Fixed rate: runs are due at start + n * period;
+    // a run never overlaps the previous one and missed due times are skipped rather than bunched up.
+    template <typename F>
+    class PeriodicRun
+    {
+    public:
+        PeriodicRun(F f, std::shared_ptr<PeriodicState> state, Promise<void> stopped, TimerQueue::Clock::duration period, TimerQueue::Clock::time_point due)
+            : m_f{std::move(f)}
+            , m_state{std::move(state)}
+            , m_stopped{std::move(stopped)}
+            , m_period{period}
+            , m_due{due}
+        {
+        }
+
+        PeriodicRun(PeriodicRun&& other) noexcept(std::is_nothrow_move_constructible_v<F>)
+            : m_f{std::move(other.m_f)}
+            , m_state{std::move(other.m_state)}
+            , m_stopped{std::move(other.m_stopped)}
+            , m_period{other.m_period}
+            , m_due{other.m_due}
+            , m_is_armed{std::exchange(other.m_is_armed, false)}
+        {
+        }
+
+        PeriodicRun& operator=(PeriodicRun&&) = delete;
+
+        // Dropped (cancelled, or the timer queue stopped) - the task has stopped without an error
+        ~PeriodicRun()
+        {
+            if (m_is_armed)
+                m_stopped.set_value();
+        }
+
+        void operator()()
+        {
+            if (m_state->is_cancelled.load())
+                return; // destructor reports the stop
+
+            try
+            {
+                m_f();
+            }
+            catch (...)
+            {
+                m_is_armed = false;
+                m_stopped.set_exception(std::current_exception());
+                return;
+            }
+
+            const auto now = TimerQueue::Clock::now();
+            m_due += m_period;
+            if (m_due < now)
+                m_due += (now - m_due) / m_period * m_period + m_period;
+
+            schedule(std::move(*this));
+        }
+
+        static void schedule(PeriodicRun run)
+        {
+            auto state = run.m_state;
+            const auto due = run.m_due;
+
+            auto timers = state->timers.lock();
+            if (!timers)
+                return; // the run is destroyed - it reports the stop
+
+            const TimerQueue::TimerId id = timers->schedule(due, Task{std::move(run)});
+            state->timer_id.store(id);
+            if (state->is_cancelled.load()) // cancel() may have looked up the previous id
+                timers->cancel(id);
+        }
+
+    private:
+        F m_f;
+        std::shared_ptr<PeriodicState> m_state;
+        Promise<void> m_stopped;
+        TimerQueue::Clock::duration m_period;
+        TimerQueue::Clock::time_point m_due;
+        bool m_is_armed = true;
+    };
+} // namespace detail
+
+#endif // TIMER_QUEUE_HPP
@@ -0,0 +1,151 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// CPU sets and NUMA nodes (Linux sysfs); on other platforms pinning is a no-op and there is a single node
+
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// Parses the kernel's cpulist format, e.g. "0-3,8,10-11"
+inline std::vector<int> parse_cpu_list(std::string_view text)
+{
+    std::vector<int> cpus;
+
+    const auto parse_number = [text](std::string_view token) {
+        int value{};
+        const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (ec != std::errc{} || ptr != token.data() + token.size() || value < 0)
+            throw std::invalid_argument{"invalid cpu list: " + std::string{text}};
+        return value;
+    };
+
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+        text.remove_suffix(1);
+
+    for (size_t pos = 0; pos < text.size();)
+    {
+        const size_t end = std::min(text.find(',', pos), text.size());
+        const std::string_view range = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        const size_t dash = range.find('-');
+        const int first = parse_number(range.substr(0, dash));
+        const int last = dash == std::string_view::npos ? first : parse_number(range.substr(dash + 1));
+        if (last < first)
+            throw std::invalid_argument{"invalid cpu list: " + std::string{text}};
+
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+// CPUs the calling thread is allowed to run on
+inline std::vector<int> available_cpus()
+{
+    std::vector<int> cpus;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+    }
+#endif
+
+    if (cpus.empty())
+    {
+        for (int cpu = 0; cpu < static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)); ++cpu)
+            cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+// Nodes with at least one CPU the process may use; a single node with all available CPUs when sysfs has no NUMA info
+inline std::vector<NumaNode> numa_topology(const std::filesystem::path& sysfs_nodes = "/sys/devices/system/node")
+{
+    const std::vector<int> allowed = available_cpus();
+    std::vector<NumaNode> nodes;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator{sysfs_nodes, ec})
+    {
+        const std::string name = entry.path().filename().string();
+        if (!name.starts_with("node") || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c); }))
+            continue;
+
+        std::ifstream cpulist{entry.path() / "cpulist"};
+        std::string text;
+        std::getline(cpulist, text);
+
+        NumaNode node{std::stoi(name.substr(4)), {}};
+        for (int cpu : parse_cpu_list(text))
+            if (std::ranges::find(allowed, cpu) != allowed.end())
+                node.cpus.push_back(cpu);
+
+        if (!node.cpus.empty())
+            nodes.push_back(std::move(node));
+    }
+
+    if (nodes.empty())
+        return {NumaNode{0, allowed}};
+
+    std::ranges::sort(nodes, {}, &NumaNode::id);
+    return nodes;
+}
+
+// CPU the calling thread is running on right now; -1 when unknown
+inline int current_cpu()
+{
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+// Restricts the calling thread to the given CPUs; false when the set was rejected
+inline bool pin_current_thread(const std::vector<int>& cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return true;
+#endif
+}
+
+#endif // TOPOLOGY_HPP
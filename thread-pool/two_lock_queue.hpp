@@ -0,0 +1,304 @@
+#ifndef TWO_LOCK_QUEUE_HPP
+#define TWO_LOCK_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// Linked queue of Michael & Scott with two locks: producers append under the tail lock, consumers unlink
+// under the head lock, so a push and a pop never wait for each other. The head always points to a dummy node -
+// the first item lives in its successor and the node of a popped item becomes the next dummy, hence head and
+// tail never touch the same node's value. A push takes the tail lock once and a pop the head lock once - neither
+// side ever takes the other's lock:
+//  - unlinked nodes are reused: consumers collect them under the head lock and hand them over a batch at a time
+//    through a lock-free stack; a producer refills its spare node (one per thread) from them while it holds
+//    the tail lock to link its item, so the next push builds its item in the spare without any lock.
+//    Once the queue has grown to its working size it no longer allocates.
+//  - a consumer finding the queue empty sleeps on an atomic signal instead of a condition variable, so
+//    a producer wakes it without taking the head lock, and pays for that only once per sleep.
+//
+// Same interface as ThreadSafeQueue: after close() pushes throw std::runtime_error and pops drain the items
+// left, then report the queue as closed.
+template <typename T>
+class TwoLockQueue
+{
+public:
+    TwoLockQueue()
+        : m_head{new Node}
+        , m_tail{m_head}
+    {
+    }
+
+    TwoLockQueue(const TwoLockQueue&) = delete;
+    TwoLockQueue& operator=(const TwoLockQueue&) = delete;
+
+    ~TwoLockQueue()
+    {
+        delete_nodes(m_head);
+        delete_nodes(m_recycled_nodes);
+        delete_nodes(m_handed_over_nodes.load(std::memory_order_acquire));
+        delete_nodes(m_free_nodes);
+    }
+
+    bool empty() const
+    {
+        std::lock_guard lk{m_mtx_head};
+        return m_head->next.load() == nullptr;
+    }
+
+    void push(const T& item)
+    {
+        emplace(item);
+    }
+
+    void push(T&& item)
+    {
+        emplace(std::move(item));
+    }
+
+    // The item is constructed in the spare node of the calling thread before the tail lock is taken - the lock
+    // covers linking the node and taking the next spare from the freelist
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        Node* node = std::exchange(tl_spare.node, nullptr);
+        if (!node)
+            node = new Node;
+
+        try
+        {
+            node->value.emplace(std::forward<Args>(args)...);
+            link(node);
+        }
+        catch (...)
+        {
+            node->value.reset();
+            if (tl_spare.node)
+                delete node;
+            else
+                tl_spare.node = node;
+            throw;
+        }
+
+        notify_consumer();
+    }
+
+    bool try_pop(T& item)
+    {
+        std::unique_lock lk{m_mtx_head, std::try_to_lock};
+        if (!lk.owns_lock())
+            return false;
+
+        Node* next = m_head->next.load();
+        if (!next)
+            return false;
+
+        item = std::move(*next->value);
+        unlink(lk, next);
+        return true;
+    }
+
+    std::optional<T> try_pop()
+    {
+        std::unique_lock lk{m_mtx_head, std::try_to_lock};
+        if (!lk.owns_lock())
+            return std::nullopt;
+
+        return take_front(lk);
+    }
+
+    // false - the queue is closed and empty
+    bool pop(T& item)
+    {
+        std::unique_lock lk{m_mtx_head};
+        wait_for_item(lk);
+
+        Node* next = m_head->next.load();
+        if (!next)
+            return false;
+
+        item = std::move(*next->value);
+        unlink(lk, next);
+        return true;
+    }
+
+    // Waits for an item; empty - the queue is closed and empty
+    std::optional<T> pop()
+    {
+        std::unique_lock lk{m_mtx_head};
+        wait_for_item(lk);
+
+        return take_front(lk);
+    }
+
+    // Wakes up all waiting consumers; idempotent
+    void close()
+    {
+        {
+            std::scoped_lock lk{m_mtx_tail, m_mtx_head};
+            m_is_closed = true;
+        }
+
+        m_item_signal.fetch_add(1);
+        m_item_signal.notify_all();
+    }
+
+    bool is_closed() const
+    {
+        std::lock_guard lk{m_mtx_head};
+        return m_is_closed;
+    }
+
+private:
+    static constexpr size_t recycle_batch = 64;
+
+    struct Node
+    {
+        std::optional<T> value;
+        std::atomic<Node*> next{nullptr}; // the only field shared by a producer and a consumer (when head == tail)
+    };
+
+    // Nodes of all queues of T are alike, so the spare of a thread serves any of them
+    struct SpareNode
+    {
+        ~SpareNode()
+        {
+            delete std::exchange(node, nullptr);
+        }
+
+        Node* node = nullptr;
+    };
+
+    static inline thread_local SpareNode tl_spare;
+
+    static void delete_nodes(Node* node)
+    {
+        while (node)
+            delete std::exchange(node, node->next.load(std::memory_order_relaxed));
+    }
+
+    void link(Node* node)
+    {
+        std::lock_guard lk{m_mtx_tail};
+        if (m_is_closed)
+            throw std::runtime_error{"TwoLockQueue: push to a closed queue"};
+
+        m_tail->next.store(node);
+        m_tail = node;
+
+        if (!tl_spare.node)
+            tl_spare.node = take_free_node();
+    }
+
+    // Called with the tail lock held - the producers are the only ones taking nodes off the freelist
+    Node* take_free_node()
+    {
+        if (!m_free_nodes)
+            m_free_nodes = m_handed_over_nodes.exchange(nullptr, std::memory_order_acquire);
+        if (!m_free_nodes)
+            return nullptr;
+
+        Node* node = std::exchange(m_free_nodes, m_free_nodes->next.load(std::memory_order_relaxed));
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
+    }
+
+    // Lock-free push of a chain of nodes; producers take the whole stack with one exchange, so there is no ABA
+    void hand_over(Node* first, Node* last)
+    {
+        Node* top = m_handed_over_nodes.load(std::memory_order_relaxed);
+        do
+            last->next.store(top, std::memory_order_relaxed);
+        while (!m_handed_over_nodes.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Called with the head lock held; returns a full batch (first, last) for the caller to hand over
+    // once it has dropped the head lock, or nullptrs while the batch is filling up
+    std::pair<Node*, Node*> recycle_node(Node* node)
+    {
+        node->next.store(m_recycled_nodes, std::memory_order_relaxed);
+        if (!m_recycled_nodes)
+            m_last_recycled_node = node;
+        m_recycled_nodes = node;
+
+        if (++m_recycled_count < recycle_batch)
+            return {nullptr, nullptr};
+
+        m_recycled_count = 0;
+        return {std::exchange(m_recycled_nodes, nullptr), std::exchange(m_last_recycled_node, nullptr)};
+    }
+
+    // Same handshake as MpmcRingQueue: a consumer raises the flag and re-checks the queue, a producer links its
+    // node and checks the flag; the seq_cst fences guarantee that one of them sees the other. The producer lowers
+    // the flag, so a run of pushes pays for one notification however long the woken consumers take to run.
+    void notify_consumer()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_consumers_asleep.load(std::memory_order_relaxed) || !m_consumers_asleep.exchange(false))
+            return;
+
+        m_item_signal.fetch_add(1);
+        m_item_signal.notify_all();
+    }
+
+    // Called with the head lock held; the lock is released while the consumer sleeps
+    void wait_for_item(std::unique_lock<std::mutex>& lk)
+    {
+        while (!m_head->next.load() && !m_is_closed)
+        {
+            const std::uint32_t observed = m_item_signal.load();
+            m_consumers_asleep.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool is_empty = m_head->next.load() == nullptr;
+            lk.unlock();
+
+            if (is_empty)
+                m_item_signal.wait(observed);
+
+            lk.lock();
+        }
+    }
+
+    // Called with the head lock held; the successor of the dummy becomes the new dummy
+    void unlink(std::unique_lock<std::mutex>& lk, Node* next)
+    {
+        next->value.reset();
+        auto [first, last] = recycle_node(std::exchange(m_head, next));
+        lk.unlock();
+
+        if (first)
+            hand_over(first, last);
+    }
+
+    std::optional<T> take_front(std::unique_lock<std::mutex>& lk)
+    {
+        Node* next = m_head->next.load();
+        if (!next)
+            return std::nullopt;
+
+        std::optional<T> item{std::move(*next->value)};
+        unlink(lk, next);
+        return item;
+    }
+
+    alignas(64) mutable std::mutex m_mtx_head;
+    Node* m_head;
+    Node* m_recycled_nodes = nullptr; // unlinked nodes not handed over yet
+    Node* m_last_recycled_node = nullptr;
+    size_t m_recycled_count = 0;
+
+    alignas(64) std::atomic<std::uint32_t> m_item_signal{0}; // bumped when a sleeping consumer may find an item
+    std::atomic<bool> m_consumers_asleep{false};
+    std::atomic<Node*> m_handed_over_nodes{nullptr}; // pushed by consumers, emptied by producers
+
+    alignas(64) std::mutex m_mtx_tail;
+    Node* m_tail;
+    bool m_is_closed = false; // written under both locks, read under either
+    Node* m_free_nodes = nullptr;
+};
+
+#endif // TWO_LOCK_QUEUE_HPP
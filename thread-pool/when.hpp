@@ -0,0 +1,295 @@
+#ifndef WHEN_HPP
+#define WHEN_HPP
+
+#include "future.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Combinators of pool futures. None of them dedicates a thread to waiting - they are driven by observers
+// called by the threads that complete the futures. Results (values or exceptions) stay in the returned futures.
+
+template <typename T>
+struct WhenAnyResult
+{
+    static constexpr size_t no_index = static_cast<size_t>(-1);
+
+    size_t index; // of the first ready future; no_index for an empty input
+    std::vector<Future<T>> futures;
+};
+
+namespace detail
+{
+    // Executor of the combined future - its continuations run where the continuations of the inputs would.
+    // The link, not the executor itself, so the combined future may outlive the pool like its inputs.
+    inline bool is_attached(const std::shared_ptr<ExecutorLink>& link)
+    {
+        return link && link->executor();
+    }
+
+    template <typename... Futures>
+    std::shared_ptr<ExecutorLink> first_executor_link(const Futures&... futures)
+    {
+        std::shared_ptr<ExecutorLink> link;
+        ((link = is_attached(link) ? link : futures.executor_link()), ...);
+        return is_attached(link) ? link : nullptr;
+    }
+
+    template <typename T>
+    std::shared_ptr<ExecutorLink> first_executor_link(const std::vector<Future<T>>& futures)
+    {
+        for (const auto& f : futures)
+        {
+            if (is_attached(f.executor_link()))
+                return f.executor_link();
+        }
+
+        return nullptr;
+    }
+} // namespace detail
+
+// Ready when all futures are ready
+template <typename... Ts>
+Future<std::tuple<Future<Ts>...>> when_all(Future<Ts>... futures)
+{
+    using Results = std::tuple<Future<Ts>...>;
+
+    struct State
+    {
+        Results results;
+        Promise<Results> promise;
+        std::atomic<size_t> remaining{sizeof...(Ts)};
+    };
+
+    auto executor_link = detail::first_executor_link(futures...);
+    auto state = std::make_shared<State>(Results{std::move(futures)...}, Promise<Results>{std::move(executor_link)});
+    auto result = state->promise.get_future();
+
+    if constexpr (sizeof...(Ts) == 0)
+        state->promise.set_value();
+    else
+    {
+        std::apply([&state](auto&... fs) {
+            (fs.on_ready([state] {
+                if (state->remaining.fetch_sub(1) == 1)
+                    state->promise.set_value(std::move(state->results));
+            }), ...);
+        }, state->results);
+    }
+
+    return result;
+}
+
+template <typename T>
+Future<std::vector<Future<T>>> when_all(std::vector<Future<T>> futures)
+{
+    struct State
+    {
+        std::vector<Future<T>> results;
+        Promise<std::vector<Future<T>>> promise;
+        std::atomic<size_t> remaining;
+    };
+
+    auto executor_link = detail::first_executor_link(futures);
+    const size_t count = futures.size();
+    auto state = std::make_shared<State>(std::move(futures), Promise<std::vector<Future<T>>>{std::move(executor_link)}, count);
+    auto result = state->promise.get_future();
+
+    if (count == 0)
+        state->promise.set_value(std::move(state->results));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state->results[i].on_ready([state] {
+            if (state->remaining.fetch_sub(1) == 1)
+                state->promise.set_value(std::move(state->results));
+        });
+    }
+
+    return result;
+}
+
+// Ready when the first of the futures is ready
+template <typename T>
+Future<WhenAnyResult<T>> when_any(std::vector<Future<T>> futures)
+{
+    struct State
+    {
+        std::vector<Future<T>> futures;
+        Promise<WhenAnyResult<T>> promise;
+        std::atomic<size_t> winner{WhenAnyResult<T>::no_index};
+        std::atomic<int> steps_left{2}; // a winner is known & all observers are attached - futures may be moved out
+
+        void finish_step()
+        {
+            if (steps_left.fetch_sub(1) == 1)
+                promise.set_value(WhenAnyResult<T>{winner.load(), std::move(futures)});
+        }
+    };
+
+    auto executor_link = detail::first_executor_link(futures);
+    auto state = std::make_shared<State>(std::move(futures), Promise<WhenAnyResult<T>>{std::move(executor_link)});
+    auto result = state->promise.get_future();
+
+    if (state->futures.empty())
+    {
+        state->promise.set_value(WhenAnyResult<T>{WhenAnyResult<T>::no_index, {}});
+        return result;
+    }
+
+    for (size_t i = 0; i < state->futures.size(); ++i)
+    {
+        state->futures[i].on_ready([state, i] {
+            size_t expected = WhenAnyResult<T>::no_index;
+            if (state->winner.compare_exchange_strong(expected, i))
+                state->finish_step();
+        });
+    }
+    state->finish_step();
+
+    return result;
+}
+
+// Input range of (index, future) pairs in the order the futures become ready:
+//   for (auto [index, f] : as_completed(std::move(futures))) ...
+// Advancing blocks until the next future is ready; a worker of the futures' pool helps it meanwhile.
+template <typename T>
+class CompletionSequence
+{
+    struct State
+    {
+        std::mutex mtx;
+        std::condition_variable cv_ready;
+        std::vector<size_t> ready; // indexes in completion order
+        std::vector<Future<T>> futures;
+        std::shared_ptr<detail::ExecutorLink> executor_link; // nullptr - none, the sequence does not help
+    };
+
+public:
+    class iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::pair<size_t, Future<T>&>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        value_type operator*() const
+        {
+            return {m_index, m_state->futures[m_index]};
+        }
+
+        iterator& operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            advance();
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return m_position == m_state->futures.size();
+        }
+
+    private:
+        friend class CompletionSequence;
+
+        explicit iterator(State* state)
+            : m_state{state}
+        {
+            if (!m_state->futures.empty())
+                m_index = wait_for_ready(0);
+        }
+
+        void advance()
+        {
+            if (++m_position < m_state->futures.size())
+                m_index = wait_for_ready(m_position);
+        }
+
+        size_t wait_for_ready(size_t position) const
+        {
+            // the executor may be destroyed while the sequence is iterated - it is reached through its link only
+            const auto& link = m_state->executor_link;
+            bool is_helping = false;
+            if (link)
+                link->with_executor([&is_helping](Executor& executor) { is_helping = executor.is_worker_thread(); });
+
+            std::unique_lock lk{m_state->mtx};
+            while (m_state->ready.size() <= position)
+            {
+                if (is_helping)
+                {
+                    lk.unlock();
+                    bool has_run = false;
+                    link->with_executor([&has_run](Executor& executor) { has_run = executor.try_run_pending_task(); });
+                    lk.lock();
+                    if (!has_run)
+                        m_state->cv_ready.wait_for(lk, detail::help_poll_interval);
+                }
+                else
+                    m_state->cv_ready.wait(lk);
+            }
+
+            return m_state->ready[position];
+        }
+
+        State* m_state = nullptr;
+        size_t m_position = 0;
+        size_t m_index = 0;
+    };
+
+    explicit CompletionSequence(std::vector<Future<T>> futures)
+        : m_state{std::make_shared<State>()}
+    {
+        m_state->executor_link = detail::first_executor_link(futures);
+        m_state->futures = std::move(futures);
+
+        for (size_t i = 0; i < m_state->futures.size(); ++i)
+        {
+            m_state->futures[i].on_ready([weak_state = std::weak_ptr{m_state}, i] {
+                if (auto state = weak_state.lock())
+                {
+                    {
+                        std::lock_guard lk{state->mtx};
+                        state->ready.push_back(i);
+                    }
+                    state->cv_ready.notify_all();
+                }
+            });
+        }
+    }
+
+    iterator begin()
+    {
+        return iterator{m_state.get()};
+    }
+
+    std::default_sentinel_t end() const
+    {
+        return std::default_sentinel;
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+};
+
+template <typename T>
+CompletionSequence<T> as_completed(std::vector<Future<T>> futures)
+{
+    return CompletionSequence<T>{std::move(futures)};
+}
+
+#endif // WHEN_HPP
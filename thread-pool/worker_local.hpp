@@ -0,0 +1,55 @@
+#ifndef WORKER_LOCAL_HPP
+#define WORKER_LOCAL_HPP
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail
+{
+    // Returns T itself (built in place, T need not be movable) or something T is initialized from
+    template <typename Factory, typename T>
+    concept factory_of = std::invocable<Factory&>
+        && (std::same_as<std::invoke_result_t<Factory&>, T> || std::convertible_to<std::invoke_result_t<Factory&>, T>);
+
+    // One instance per thread for every (T, Key) pair. The factory comes in type-erased, so the instance depends
+    // only on T and Key - not on whether the factory is passed as an lvalue, a const lvalue or an rvalue.
+    template <typename T, typename Key>
+    T& worker_local_instance(T (*make)(void*), void* factory)
+    {
+        static thread_local T instance = make(factory);
+        return instance;
+    }
+} // namespace detail
+
+// Instance of T owned by the calling thread: built by the first task that asks for it on a worker
+// and reused by every later task on that worker; destroyed when the worker exits (after on_worker_stop).
+// Expensive per-thread state - random engines, scratch buffers, arenas - is then set up once per worker
+// instead of once per task:
+//
+//   auto& gen = worker_local<std::mt19937_64>([] { return std::mt19937_64{std::random_device{}()}; });
+//
+// Instances are told apart by T and the type of the factory, so every lambda gets its own instance.
+// Only the first call on a thread runs the factory - later calls with a factory of the same type get
+// that instance, whatever state their factory captures.
+// The instance belongs to the thread, not to a pool: a thread helping the pool (e.g. the caller of
+// parallel_for) gets an instance of its own, and a thread that runs tasks of several pools shares one.
+template <typename T, typename Factory>
+    requires detail::factory_of<std::remove_reference_t<Factory>, T>
+T& worker_local(Factory&& factory)
+{
+    using Fn = std::remove_reference_t<Factory>;
+
+    auto make = [](void* fn) -> T { return std::invoke(*static_cast<Fn*>(fn)); };
+    return detail::worker_local_instance<T, std::remove_cv_t<Fn>>(make, const_cast<std::remove_cv_t<Fn>*>(std::addressof(factory)));
+}
+
+template <std::default_initializable T>
+T& worker_local()
+{
+    return worker_local<T>([] { return T{}; });
+}
+
+#endif // WORKER_LOCAL_HPP